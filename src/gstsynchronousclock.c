@@ -61,14 +61,28 @@
 #endif
 
 #include <gst/gst.h>
+#include <gst/audio/gstaudiobasesink.h>
 #include <time.h>
 #include <stdio.h>
 #include "gstsynchronousclock.h"
+#include "gstsynchronousclocksrc.h"
 
 #define LOCK_CLOCK(p)    g_mutex_lock(&p->priv->mutex);
 #define UNLOCK_CLOCK(p)  g_mutex_unlock(&p->priv->mutex);
 
+/* 64-bit atomics, GLib only provides them for pointer-sized values */
+#define ATOMIC_GET(p)     __atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_SET(p, v)  __atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_ADD(p, v)  __atomic_add_fetch ((p), (v), __ATOMIC_ACQ_REL)
+
 #define DEFAULT_TICK 32 * 1000000 /*ns*/
+#define DEFAULT_COALESCE_WINDOW 0 /*ns*/
+#define DEFAULT_MODE GST_SYNCHRONOUS_CLOCK_MODE_MANUAL
+#define DEFAULT_MAX_LATENCY 0 /*ns*/
+#define DEFAULT_TIMELINE_SIZE 0 /*records*/
+
+#define DUMP_CHUNK 256 /*records*/
+#define STAMP_BUSY G_MAXUINT64
 
 GST_DEBUG_CATEGORY_STATIC (gst_synchronous_clock_debug);
 #define GST_CAT_DEFAULT gst_synchronous_clock_debug
@@ -78,15 +92,83 @@ static const char *short_description = "A deterministic clock";
 enum
 {
   PROP_TICK = 1,
+  PROP_COALESCE_WINDOW,
+  PROP_MODE,
+  PROP_MAX_LATENCY,
+  PROP_CURRENT_TICK,
+  PROP_TIMELINE_SIZE,
 };
 
+/* A clock entry waiting for the virtual time to reach its deadline */
+typedef struct
+{
+  GstClockEntry *entry;
+  gboolean async;
+} SynchronousClockWaiter;
+
+/* A timeline slot. 'stamp' is the sequence number of the record it holds
+ * plus one (0 when empty), or STAMP_BUSY while the record is written. */
+typedef struct
+{
+  uint64_t stamp;
+  GstSynchronousClockRecord record;
+} SynchronousClockSlot;
+
+/* Time is read without the lock. It is 'advanced', the sum of all advances,
+ * on top of a base: 'cur_time' in manual mode or, when following the wall
+ * clock, the monotonic time plus 'offset'. Advancing never takes the lock;
+ * it only serializes mode switches and the entry queue. A mode switch
+ * publishes the mode and its base under 'mode_seq', a sequence count that
+ * is odd while the switch is in progress. */
 struct _GstSynchronousClockPrivate 
 {
   uint64_t cur_time;
+  int64_t offset;
+  uint64_t advanced;
+  uint64_t last_time;   /* highest time ever returned */
+  gint mode;
+  gint mode_seq;
+  gint hold;            /* number of holds in place */
+  gint advancing;       /* advances past the hold check */
+  gint releasing;       /* a thread is releasing entries */
+  gint release_pending; /* an advance is waiting for a release pass */
+  uint64_t current_tick;
   GMutex mutex;
+  GCond entries_cond;
+  GCond pending_cond;   /* signaled when an entry is queued */
+  guint64 n_queued;     /* number of entries ever queued */
+  GCond hold_cond;      /* signaled when a hold or an advance ends */
+  GList *waiters;       /* SynchronousClockWaiter, sorted by deadline */
+  GList *followers;     /* GstClock, re-anchored on each release pass */
   GstClock *internal_clock;
+  GstClockID follow_id; /* wakes up the head entry when following */
+
+  SynchronousClockSlot *timeline;
+  guint timeline_size;
+  uint64_t timeline_head; /* number of records ever claimed */
 };
 
+GType
+gst_synchronous_clock_mode_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {GST_SYNCHRONOUS_CLOCK_MODE_MANUAL, "Time only moves when advanced",
+        "manual"},
+    {GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW, "Time follows the monotonic clock",
+        "follow"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id))
+  {
+    GType tmp = g_enum_register_static ("GstSynchronousClockMode", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
 G_DEFINE_TYPE (GstSynchronousClock, gst_synchronous_clock,
     GST_TYPE_SYSTEM_CLOCK)
 
@@ -95,6 +177,11 @@ static void gst_synchronous_clock_set_property (GObject *, guint,
 static void gst_synchronous_clock_get_property (GObject *, guint,GValue *,
     GParamSpec *);
 static GstClockTime synchronous_clock_get_internal_time (GstClock *);
+static GstClockReturn synchronous_clock_wait (GstClock *, GstClockEntry *,
+    GstClockTimeDiff *);
+static GstClockReturn synchronous_clock_wait_async (GstClock *,
+    GstClockEntry *);
+static void synchronous_clock_unschedule (GstClock *, GstClockEntry *);
 static void synchronous_clock_finalize (GObject *);
 
 /* GObject vmethod implementations */
@@ -114,23 +201,564 @@ gst_synchronous_clock_class_init (GstSynchronousClockClass * klass)
   gobject_class->get_property = gst_synchronous_clock_get_property;
 
   clock_class->get_internal_time = synchronous_clock_get_internal_time;
+  clock_class->wait = synchronous_clock_wait;
+  clock_class->wait_async = synchronous_clock_wait_async;
+  clock_class->unschedule = synchronous_clock_unschedule;
   
   g_object_class_install_property (gobject_class, PROP_TICK,
       g_param_spec_uint64 ("tick", "Tick", "Ammount of time used in each "
         "tick within the function gst_synchronous_clock_tick_for",
           1, G_MAXUINT64, DEFAULT_TICK, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_COALESCE_WINDOW,
+      g_param_spec_uint64 ("coalesce-window", "Coalesce window", "Amount "
+        "of time the earliest pending entry may be held back so that entries "
+        "with deadlines inside the window are released in the same batch "
+        "(0 = release each entry as soon as it is due)",
+          0, G_MAXUINT64, DEFAULT_COALESCE_WINDOW, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode", "Whether time only moves when "
+        "advanced or follows the monotonic clock. Switching never makes "
+        "time go backwards", GST_TYPE_SYNCHRONOUSCLOCK_MODE, DEFAULT_MODE,
+          G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_LATENCY,
+      g_param_spec_uint64 ("max-latency", "Max latency", "When non-zero, "
+        "gst_synchronous_clock_tick_for steps straight to the next pending "
+        "deadline, but never more than this amount of time at once "
+        "(0 = fixed steps of 'tick')",
+          0, G_MAXUINT64, DEFAULT_MAX_LATENCY, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_CURRENT_TICK,
+      g_param_spec_uint64 ("current-tick", "Current tick", "Amount of time "
+        "used in the latest tick within the function "
+        "gst_synchronous_clock_tick_for",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+  g_object_class_install_property (gobject_class, PROP_TIMELINE_SIZE,
+      g_param_spec_uint ("timeline-size", "Timeline size", "Number of "
+        "records kept of the latest advances, the oldest being overwritten "
+        "(0 = no timeline)", 0, G_MAXUINT, DEFAULT_TIMELINE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static uint64_t
+synchronous_clock_mode_base (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+
+  if (g_atomic_int_get (&priv->mode) == GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW)
+    return (uint64_t) ((int64_t) gst_clock_get_time (priv->internal_clock) 
+        + ATOMIC_GET (&priv->offset));
+  else
+    return ATOMIC_GET (&priv->cur_time);
+}
+
+/* Retries until no mode switch overlapped the read, so the base never mixes
+ * the old mode with the new one: a base read in follow mode is then from
+ * before the switch froze the time and can't be beyond the frozen time. */
+static uint64_t
+synchronous_clock_base (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  uint64_t base;
+  gint seq;
+
+  do
+  {
+    while ((seq = g_atomic_int_get (&priv->mode_seq)) & 1)
+      g_thread_yield ();
+    base = synchronous_clock_mode_base (self);
+  } while (g_atomic_int_get (&priv->mode_seq) != seq);
+
+  return base;
+}
+
+/* Keep the highest time returned so far and never go below it, in case
+ * a reader races with an advance landing between the base and 'advanced' */
+static uint64_t
+synchronous_clock_clamp (GstSynchronousClock *self, uint64_t now)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  uint64_t last;
+
+  last = ATOMIC_GET (&priv->last_time);
+  while (now > last && !__atomic_compare_exchange_n (&priv->last_time, &last,
+        now, TRUE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    ;
+
+  return MAX (now, last);
+}
+
+static uint64_t
+synchronous_clock_now (GstSynchronousClock *self)
+{
+  return synchronous_clock_clamp (self, synchronous_clock_base (self)
+      + ATOMIC_GET (&self->priv->advanced));
 }
 
 static GstClockTime 
 synchronous_clock_get_internal_time (GstClock *clock)
 {
   GstSynchronousClock *myclock = GST_SYNCHRONOUSCLOCK (clock);
-  GstClockTime time;
- 
-  LOCK_CLOCK (myclock);
-  time = myclock->priv->cur_time;
-  UNLOCK_CLOCK (myclock);
-  return time;
+  return synchronous_clock_now (myclock);
+}
+
+static gboolean synchronous_clock_follow_cb (GstClock *, GstClockTime,
+    GstClockID, gpointer);
+
+static void
+synchronous_clock_weak_ref_free (gpointer data)
+{
+  g_weak_ref_clear (data);
+  g_free (data);
+}
+
+/* When following the wall clock, arms a single shot id on the internal
+ * clock for the moment the head entry is due. Followers would drift from
+ * a clock that moves by itself, so with any of them the id also fires
+ * every 'tick' to re-anchor them. The id only holds a weak reference, so
+ * an armed clock can still be finalized. */
+static void
+synchronous_clock_arm_unlocked (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  GWeakRef *ref;
+  int64_t target = G_MAXINT64;
+
+  if (priv->follow_id != NULL)
+  {
+    gst_clock_id_unschedule (priv->follow_id);
+    gst_clock_id_unref (priv->follow_id);
+    priv->follow_id = NULL;
+  }
+
+  if (g_atomic_int_get (&priv->mode) != GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW 
+      || (priv->waiters == NULL && priv->followers == NULL))
+    return;
+
+  if (priv->waiters != NULL)
+  {
+    SynchronousClockWaiter *head = priv->waiters->data;
+    target = (int64_t) (GST_CLOCK_ENTRY_TIME (head->entry) 
+        + self->coalesce_window - ATOMIC_GET (&priv->advanced)) 
+        - ATOMIC_GET (&priv->offset);
+  }
+
+  if (priv->followers != NULL)
+    target = MIN (target, (int64_t) (gst_clock_get_time (priv->internal_clock)
+          + self->tick));
+
+  ref = g_new0 (GWeakRef, 1);
+  g_weak_ref_init (ref, self);
+  priv->follow_id = gst_clock_new_single_shot_id (priv->internal_clock,
+      (GstClockTime) MAX (target, 0));
+  gst_clock_id_wait_async (priv->follow_id, synchronous_clock_follow_cb,
+      ref, synchronous_clock_weak_ref_free);
+}
+
+/* Entry times are compared against the internal time: the synchronous clock
+ * is meant to be the master of the pipeline, so it is never calibrated. */
+static void
+synchronous_clock_queue_unlocked (GstSynchronousClock *self,
+    GstClockEntry *entry, gboolean async)
+{
+  SynchronousClockWaiter *waiter;
+  GList *l;
+
+  waiter = g_new0 (SynchronousClockWaiter, 1);
+  waiter->entry = entry;
+  waiter->async = async;
+  self->priv->n_queued++;
+  g_cond_broadcast (&self->priv->pending_cond);
+
+  /* entries with the same deadline keep the order they were scheduled in */
+  for (l = g_list_last (self->priv->waiters); l != NULL; l = l->prev)
+  {
+    SynchronousClockWaiter *other = l->data;
+    if (gst_clock_id_compare_func (other->entry, entry) <= 0)
+      break;
+  }
+
+  if (l == NULL)
+  {
+    self->priv->waiters = g_list_prepend (self->priv->waiters, waiter);
+    synchronous_clock_arm_unlocked (self);
+  }
+  else
+    self->priv->waiters = g_list_insert_before (self->priv->waiters, l->next,
+        waiter);
+}
+
+/* Releases every entry due at the current time. When 'coalesce_window' is
+ * set, the earliest deadline is held back until it is 'coalesce_window'
+ * overdue, so entries with nearby deadlines go out in the same batch.
+ * Sync waiters are woken by a single broadcast; async entries are returned,
+ * in deadline order, so their callbacks can run without the clock lock. */
+static GList *
+synchronous_clock_release_unlocked (GstSynchronousClock *self, 
+    guint *n_released)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  SynchronousClockWaiter *head;
+  GList *released = NULL;
+  gboolean woken = FALSE;
+  uint64_t now = synchronous_clock_now (self);
+
+  *n_released = 0;
+  if (priv->waiters == NULL)
+    return NULL;
+
+  head = priv->waiters->data;
+  if (GST_CLOCK_ENTRY_TIME (head->entry) > now 
+      || now - GST_CLOCK_ENTRY_TIME (head->entry) < self->coalesce_window)
+    return NULL;
+
+  while (priv->waiters != NULL)
+  {
+    SynchronousClockWaiter *waiter = priv->waiters->data;
+    if (GST_CLOCK_ENTRY_TIME (waiter->entry) > now)
+      break;
+
+    priv->waiters = g_list_delete_link (priv->waiters, priv->waiters);
+    GST_CLOCK_ENTRY_STATUS (waiter->entry) = GST_CLOCK_OK;
+    (*n_released)++;
+
+    if (waiter->async)
+      released = g_list_prepend (released, waiter->entry);
+    else
+      woken = TRUE;
+
+    g_free (waiter);
+  }
+
+  if (woken)
+    g_cond_broadcast (&priv->entries_cond);
+
+  return g_list_reverse (released);
+}
+
+/* Runs the callbacks of released async entries, in deadline order, and
+ * reschedules the periodic ones. Must be called without the clock lock. */
+static void
+synchronous_clock_dispatch (GstSynchronousClock *self, GList *released)
+{
+  GList *l;
+
+  for (l = released; l != NULL; l = l->next)
+  {
+    GstClockEntry *entry = l->data;
+
+    if (entry->func != NULL)
+      entry->func (GST_CLOCK (self), GST_CLOCK_ENTRY_TIME (entry),
+          (GstClockID) entry, entry->user_data);
+
+    LOCK_CLOCK (self);
+    if (GST_CLOCK_ENTRY_TYPE (entry) == GST_CLOCK_ENTRY_PERIODIC
+        && GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_OK)
+    {
+      GST_CLOCK_ENTRY_TIME (entry) += GST_CLOCK_ENTRY_INTERVAL (entry);
+      GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_BUSY;
+      synchronous_clock_queue_unlocked (self, entry, TRUE);
+      entry = NULL;
+    }
+    UNLOCK_CLOCK (self);
+
+    if (entry != NULL)
+      gst_clock_id_unref (entry);
+  }
+  g_list_free (released);
+}
+
+/* Size of the next step of tick_for. With 'max_latency' set, the step ends
+ * right when the head entry is due, so it is released without tick
+ * quantization; with nothing pending it is 'max_latency'. Such a step is
+ * slept first and advanced at its end, so time never runs ahead of the
+ * wall clock, and it is cut short by any earlier entry scheduled while it
+ * is slept (see synchronous_clock_sleep_step). */
+static uint64_t
+synchronous_clock_next_tick (GstSynchronousClock *self, uint64_t amount)
+{
+  uint64_t step = self->tick;
+
+  if (self->max_latency > 0)
+  {
+    step = self->max_latency;
+
+    LOCK_CLOCK (self);
+    if (self->priv->waiters != NULL)
+    {
+      SynchronousClockWaiter *head = self->priv->waiters->data;
+      uint64_t due = GST_CLOCK_ENTRY_TIME (head->entry) 
+          + self->coalesce_window;
+      uint64_t now = synchronous_clock_now (self);
+
+      step = due > now ? MIN (step, due - now) : 1;
+    }
+    UNLOCK_CLOCK (self);
+  }
+
+  step = MIN (step, amount);
+  ATOMIC_SET (&self->priv->current_tick, step);
+  return step;
+}
+
+/* Sleeps an adaptive step of tick_for in real time. An entry scheduled
+ * meanwhile that is due before the step ends shortens it, so the step
+ * still ends on the earliest deadline instead of overshooting it, e.g.,
+ * when a sink re-queues right after its previous entry was released.
+ * Returns the step actually slept. */
+static uint64_t
+synchronous_clock_sleep_step (GstSynchronousClock *self, uint64_t step)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  gint64 start = g_get_monotonic_time ();
+
+  LOCK_CLOCK (self);
+  while (g_cond_wait_until (&priv->pending_cond, &priv->mutex,
+        start + (gint64) (step / GST_USECOND)))
+  {
+    SynchronousClockWaiter *head;
+    uint64_t due, now;
+
+    if (priv->waiters == NULL)
+      continue;
+
+    head = priv->waiters->data;
+    due = GST_CLOCK_ENTRY_TIME (head->entry) + self->coalesce_window;
+    now = synchronous_clock_now (self);
+    if (due < now + step)
+      step = due > now ? due - now : 1;
+  }
+  UNLOCK_CLOCK (self);
+
+  ATOMIC_SET (&priv->current_tick, step);
+  return step;
+}
+
+/* Anchors the internal time of each follower to the current time, so
+ * followers see every advance as it happens instead of estimating it. */
+static void
+synchronous_clock_update_followers (GstSynchronousClock *self)
+{
+  GList *followers, *l;
+  GstClockTime now;
+
+  LOCK_CLOCK (self);
+  followers = g_list_copy_deep (self->priv->followers, 
+      (GCopyFunc) gst_object_ref, NULL);
+  UNLOCK_CLOCK (self);
+
+  if (followers == NULL)
+    return;
+
+  now = synchronous_clock_now (self);
+  for (l = followers; l != NULL; l = l->next)
+  {
+    GstClock *follower = l->data;
+    GstClockTime internal = gst_clock_get_internal_time (follower);
+
+    if (GST_CLOCK_TIME_IS_VALID (internal))
+      gst_clock_set_calibration (follower, internal, now, 1, 1);
+  }
+  g_list_free_full (followers, gst_object_unref);
+}
+
+/* Appends a record to the timeline, from any number of threads at once:
+ * each claims the next slot with a fetch-add on the head and publishes it
+ * by stamping the slot with its sequence number. It never allocates. */
+static void
+synchronous_clock_record (GstSynchronousClock *self, uint64_t time,
+    uint64_t wall_time, guint n_released, guint source)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  SynchronousClockSlot *slot;
+  uint64_t seq, stamp;
+
+  if (priv->timeline == NULL)
+    return;
+
+  seq = __atomic_fetch_add (&priv->timeline_head, 1, __ATOMIC_ACQ_REL);
+  slot = &priv->timeline[seq % priv->timeline_size];
+
+  /* the slot is shared only with records a whole ring apart: wait for a
+   * writer that far behind, and never overwrite a newer record */
+  stamp = ATOMIC_GET (&slot->stamp);
+  do
+  {
+    while (stamp == STAMP_BUSY)
+    {
+      g_thread_yield ();
+      stamp = ATOMIC_GET (&slot->stamp);
+    }
+    if (stamp > seq + 1)
+      return;
+  } while (!__atomic_compare_exchange_n (&slot->stamp, &stamp, STAMP_BUSY,
+        FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  /* keep the writes below after the stamp above */
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  slot->record.time = time;
+  slot->record.wall_time = wall_time;
+  slot->record.released = n_released;
+  slot->record.source = source;
+  ATOMIC_SET (&slot->stamp, seq + 1);
+}
+
+/* Only one thread at a time goes through the release stage. A thread that
+ * moved time and finds it busy just flags a pending release and returns;
+ * the releasing thread keeps making passes until no flag is left, so no
+ * release is lost and advancing threads never wait on each other. Returns
+ * the number of entries released by the passes made by the caller. */
+static guint
+synchronous_clock_release (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+  guint total = 0;
+
+  g_atomic_int_set (&priv->release_pending, TRUE);
+  while (g_atomic_int_get (&priv->release_pending)
+      && g_atomic_int_compare_and_exchange (&priv->releasing, FALSE, TRUE))
+  {
+    while (g_atomic_int_compare_and_exchange (&priv->release_pending, 
+          TRUE, FALSE))
+    {
+      GList *released;
+      guint n_released;
+
+      LOCK_CLOCK (self);
+      released = synchronous_clock_release_unlocked (self, &n_released);
+      synchronous_clock_arm_unlocked (self);
+      UNLOCK_CLOCK (self);
+
+      total += n_released;
+      synchronous_clock_dispatch (self, released);
+      synchronous_clock_update_followers (self);
+    }
+    g_atomic_int_set (&priv->releasing, FALSE);
+  }
+
+  return total;
+}
+
+static gboolean
+synchronous_clock_follow_cb (GstClock *internal_clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  GstSynchronousClock *self = g_weak_ref_get (user_data);
+  gboolean current;
+
+  if (self == NULL)
+    return TRUE;
+
+  /* ignore ids that were replaced while this one was firing */
+  LOCK_CLOCK (self);
+  current = id == self->priv->follow_id;
+  UNLOCK_CLOCK (self);
+
+  if (current)
+  {
+    uint64_t wall_time = gst_clock_get_time (internal_clock);
+    guint n_released = synchronous_clock_release (self);
+
+    synchronous_clock_record (self, synchronous_clock_now (self), wall_time,
+        n_released, GST_SYNCHRONOUS_CLOCK_SOURCE_WALL_CLOCK);
+  }
+  gst_object_unref (self);
+  return TRUE;
+}
+
+static GstClockReturn
+synchronous_clock_wait (GstClock *clock, GstClockEntry *entry,
+    GstClockTimeDiff *jitter)
+{
+  GstSynchronousClock *self = GST_SYNCHRONOUSCLOCK (clock);
+  GstClockTime entryt = GST_CLOCK_ENTRY_TIME (entry);
+  GstClockTime now;
+  GstClockReturn ret;
+
+  LOCK_CLOCK (self);
+  if (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)
+  {
+    UNLOCK_CLOCK (self);
+    return GST_CLOCK_UNSCHEDULED;
+  }
+
+  now = synchronous_clock_now (self);
+  if (jitter)
+    *jitter = GST_CLOCK_DIFF (entryt, now);
+
+  if (entryt <= now)
+  {
+    UNLOCK_CLOCK (self);
+    return GST_CLOCK_EARLY;
+  }
+
+  GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_BUSY;
+  synchronous_clock_queue_unlocked (self, entry, FALSE);
+
+  while (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_BUSY)
+    g_cond_wait (&self->priv->entries_cond, &self->priv->mutex);
+
+  ret = GST_CLOCK_ENTRY_STATUS (entry);
+  UNLOCK_CLOCK (self);
+
+  return ret;
+}
+
+/* Async entries are never dispatched from here, even when already due:
+ * callers such as gst_clock_set_master hold locks the callback needs. They
+ * fire on the next release, i.e., on the next advance of time or, when
+ * following the wall clock, from the internal clock's thread. */
+static GstClockReturn
+synchronous_clock_wait_async (GstClock *clock, GstClockEntry *entry)
+{
+  GstSynchronousClock *self = GST_SYNCHRONOUSCLOCK (clock);
+
+  LOCK_CLOCK (self);
+  if (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)
+  {
+    UNLOCK_CLOCK (self);
+    return GST_CLOCK_UNSCHEDULED;
+  }
+
+  GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_BUSY;
+  synchronous_clock_queue_unlocked (self, gst_clock_id_ref (entry), TRUE);
+  UNLOCK_CLOCK (self);
+
+  return GST_CLOCK_OK;
+}
+
+static void
+synchronous_clock_unschedule (GstClock *clock, GstClockEntry *entry)
+{
+  GstSynchronousClock *self = GST_SYNCHRONOUSCLOCK (clock);
+  GList *l;
+
+  LOCK_CLOCK (self);
+  for (l = self->priv->waiters; l != NULL; l = l->next)
+  {
+    SynchronousClockWaiter *waiter = l->data;
+    if (waiter->entry != entry)
+      continue;
+
+    if (l == self->priv->waiters)
+    {
+      self->priv->waiters = g_list_delete_link (self->priv->waiters, l);
+      synchronous_clock_arm_unlocked (self);
+    }
+    else
+      self->priv->waiters = g_list_delete_link (self->priv->waiters, l);
+    if (waiter->async)
+      gst_clock_id_unref (entry);
+    g_free (waiter);
+    break;
+  }
+
+  GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_UNSCHEDULED;
+  g_cond_broadcast (&self->priv->entries_cond);
+  UNLOCK_CLOCK (self);
 }
 
 /* initialize the new element
@@ -142,8 +770,14 @@ static void
 gst_synchronous_clock_init (GstSynchronousClock * self)
 {
   self->tick = DEFAULT_TICK;
+  self->coalesce_window = DEFAULT_COALESCE_WINDOW;
+  self->max_latency = DEFAULT_MAX_LATENCY;
   self->priv = g_new0 (GstSynchronousClockPrivate, 1);
+  self->priv->mode = DEFAULT_MODE;
   g_mutex_init (&self->priv->mutex);
+  g_cond_init (&self->priv->entries_cond);
+  g_cond_init (&self->priv->pending_cond);
+  g_cond_init (&self->priv->hold_cond);
   self->priv->internal_clock = gst_system_clock_obtain ();
 }
 
@@ -152,9 +786,33 @@ static void
 synchronous_clock_finalize (GObject *object)
 {
   GstSynchronousClock *self = GST_SYNCHRONOUSCLOCK (object);
-  g_free (self->priv);
+  GList *l;
+
+  /* only async entries can outlive their waiters */
+  for (l = self->priv->waiters; l != NULL; l = l->next)
+  {
+    SynchronousClockWaiter *waiter = l->data;
+    if (waiter->async)
+      gst_clock_id_unref (waiter->entry);
+    g_free (waiter);
+  }
+  g_list_free (self->priv->waiters);
+
+  g_list_free_full (self->priv->followers, gst_object_unref);
+  g_free (self->priv->timeline);
+
+  if (self->priv->follow_id != NULL)
+  {
+    gst_clock_id_unschedule (self->priv->follow_id);
+    gst_clock_id_unref (self->priv->follow_id);
+  }
+
   g_mutex_clear (&self->priv->mutex);
+  g_cond_clear (&self->priv->entries_cond);
+  g_cond_clear (&self->priv->pending_cond);
+  g_cond_clear (&self->priv->hold_cond);
   g_object_unref (self->priv->internal_clock);
+  g_free (self->priv);
 
   G_OBJECT_CLASS (gst_synchronous_clock_parent_class)->finalize(object);
 }
@@ -172,6 +830,32 @@ gst_synchronous_clock_set_property (GObject *object, guint prop_id,
       clock->tick = g_value_get_uint64 (value);
       break;
     }
+    case PROP_COALESCE_WINDOW:
+    {
+      clock->coalesce_window = g_value_get_uint64 (value);
+      break;
+    }
+    case PROP_MODE:
+    {
+      gst_synchronous_clock_set_mode (GST_CLOCK (clock), 
+          g_value_get_enum (value));
+      break;
+    }
+    case PROP_MAX_LATENCY:
+    {
+      clock->max_latency = g_value_get_uint64 (value);
+      break;
+    }
+    case PROP_TIMELINE_SIZE:
+    {
+      clock->priv->timeline_size = g_value_get_uint (value);
+      g_free (clock->priv->timeline);
+      clock->priv->timeline = NULL;
+      if (clock->priv->timeline_size > 0)
+        clock->priv->timeline = g_new0 (SynchronousClockSlot, 
+            clock->priv->timeline_size);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -191,6 +875,31 @@ gst_synchronous_clock_get_property (GObject * object, guint prop_id,
       g_value_set_uint64 (value, clock->tick);
       break;
     }
+    case PROP_COALESCE_WINDOW:
+    {
+      g_value_set_uint64 (value, clock->coalesce_window);
+      break;
+    }
+    case PROP_MODE:
+    {
+      g_value_set_enum (value, g_atomic_int_get (&clock->priv->mode));
+      break;
+    }
+    case PROP_MAX_LATENCY:
+    {
+      g_value_set_uint64 (value, clock->max_latency);
+      break;
+    }
+    case PROP_CURRENT_TICK:
+    {
+      g_value_set_uint64 (value, ATOMIC_GET (&clock->priv->current_tick));
+      break;
+    }
+    case PROP_TIMELINE_SIZE:
+    {
+      g_value_set_uint (value, clock->priv->timeline_size);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -212,7 +921,8 @@ synchronousclock_init (GstPlugin * myclock)
    */
   GST_DEBUG_CATEGORY_INIT (gst_synchronous_clock_debug, "synchronousclock",
       0, short_description);
-  return TRUE;
+  return gst_element_register (myclock, "synchronousclocksrc", GST_RANK_NONE,
+      GST_TYPE_SYNCHRONOUSCLOCKSRC);
 }
 
 GstClock *
@@ -223,17 +933,72 @@ gst_synchronous_clock_new ()
   return ret;
 }
 
+static void
+synchronous_clock_end_advance (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+
+  if (g_atomic_int_dec_and_test (&priv->advancing) 
+      && g_atomic_int_get (&priv->hold) > 0)
+  {
+    LOCK_CLOCK (self);
+    g_cond_broadcast (&priv->hold_cond);
+    UNLOCK_CLOCK (self);
+  }
+}
+
+/* Blocks while the time is held. An advance counts itself in 'advancing'
+ * before checking 'hold' and a hold sets 'hold' before checking
+ * 'advancing', so either the advance waits or the hold waits for it. */
+static void
+synchronous_clock_begin_advance (GstSynchronousClock *self)
+{
+  GstSynchronousClockPrivate *priv = self->priv;
+
+  g_atomic_int_inc (&priv->advancing);
+  while (g_atomic_int_get (&priv->hold) > 0)
+  {
+    synchronous_clock_end_advance (self);
+
+    LOCK_CLOCK (self);
+    while (g_atomic_int_get (&priv->hold) > 0)
+      g_cond_wait (&priv->hold_cond, &priv->mutex);
+    UNLOCK_CLOCK (self);
+
+    g_atomic_int_inc (&priv->advancing);
+  }
+}
+
 gboolean
 gst_synchronous_clock_advance_time (GstClock *clock, uint64_t time)
+{
+  return gst_synchronous_clock_advance_time_from (clock, time, 
+      GST_SYNCHRONOUS_CLOCK_SOURCE_API);
+}
+
+gboolean
+gst_synchronous_clock_advance_time_from (GstClock *clock, uint64_t time,
+    guint source)
 {
   GstSynchronousClock *my_clock;
+  uint64_t now, wall_time = 0;
+  guint n_released;
   g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), FALSE);
   my_clock = GST_SYNCHRONOUSCLOCK (clock);
-  LOCK_CLOCK (my_clock);
-  my_clock->priv->cur_time += time;
-  GST_DEBUG ("%" GST_TIME_FORMAT "\n", 
-      GST_TIME_ARGS (my_clock->priv->cur_time));
-  UNLOCK_CLOCK (my_clock);
+
+  /* safe from any number of threads; while following the wall clock this
+   * jumps ahead without leaving the mode. 'now' is where this very advance
+   * took the time, whatever the concurrent ones do. */
+  synchronous_clock_begin_advance (my_clock);
+  now = synchronous_clock_base (my_clock) 
+      + ATOMIC_ADD (&my_clock->priv->advanced, time);
+  synchronous_clock_end_advance (my_clock);
+  GST_DEBUG ("%" GST_TIME_FORMAT "\n", GST_TIME_ARGS (now));
+
+  if (my_clock->priv->timeline != NULL)
+    wall_time = gst_clock_get_time (my_clock->priv->internal_clock);
+  n_released = synchronous_clock_release (my_clock);
+  synchronous_clock_record (my_clock, now, wall_time, n_released, source);
 
   return TRUE;
 }
@@ -252,12 +1017,30 @@ gst_synchronous_clock_tick_for (GstClock *clock, uint64_t amount,
   {
     GstClockID clock_id;
     uint64_t time;
+    gboolean manual, adaptive;
     if (g_cancellable_is_cancelled(cancellable))
       break;
 
-    time = amount < my_clock->tick ? amount : my_clock->tick;
+    time = synchronous_clock_next_tick (my_clock, amount);
+    /* when following the wall clock, time moves by itself while we sleep */
+    manual = gst_synchronous_clock_get_mode (clock) 
+        == GST_SYNCHRONOUS_CLOCK_MODE_MANUAL;
+    adaptive = my_clock->max_latency > 0;
+
+    /* adaptive steps end on a deadline, reach it only once it has passed */
+    if (manual && adaptive)
+    {
+      time = synchronous_clock_sleep_step (my_clock, time);
+      amount -= time;
+      gst_synchronous_clock_advance_time_from (clock, time,
+          GST_SYNCHRONOUS_CLOCK_SOURCE_TICK_FOR);
+      continue;
+    }
+
     amount -= time;
-    gst_synchronous_clock_advance_time (clock, time);
+    if (manual)
+      gst_synchronous_clock_advance_time_from (clock, time,
+          GST_SYNCHRONOUS_CLOCK_SOURCE_TICK_FOR);
     clock_id = gst_clock_new_single_shot_id (
         my_clock->priv->internal_clock, 
         gst_clock_get_time(my_clock->priv->internal_clock) + time);
@@ -269,6 +1052,368 @@ gst_synchronous_clock_tick_for (GstClock *clock, uint64_t amount,
   }
 }
 
+void
+gst_synchronous_clock_set_mode (GstClock *clock, 
+    GstSynchronousClockMode mode)
+{
+  GstSynchronousClock *my_clock;
+  GstSynchronousClockPrivate *priv;
+  uint64_t now, advanced;
+
+  g_return_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock));
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+  priv = my_clock->priv;
+
+  LOCK_CLOCK (my_clock);
+  if (g_atomic_int_get (&priv->mode) == (gint) mode)
+  {
+    UNLOCK_CLOCK (my_clock);
+    return;
+  }
+
+  /* pick up exactly where the current mode is, so time is continuous. The
+   * new base leaves out the one 'advanced' read here, so an advance racing
+   * with the switch is counted once, whichever side of it it lands on.
+   * Readers wait while 'mode_seq' is odd, so none of them can return a
+   * time read in the old mode after 'now' below, and the first step taken
+   * after a pause lands exactly on 'now' plus the step. */
+  g_atomic_int_inc (&priv->mode_seq);
+  advanced = ATOMIC_GET (&priv->advanced);
+  now = synchronous_clock_clamp (my_clock, 
+      synchronous_clock_mode_base (my_clock) + advanced);
+  if (mode == GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW)
+    ATOMIC_SET (&priv->offset, (int64_t) (now - advanced) 
+        - (int64_t) gst_clock_get_time (priv->internal_clock));
+  else
+    ATOMIC_SET (&priv->cur_time, now - advanced);
+
+  g_atomic_int_set (&priv->mode, mode);
+  g_atomic_int_inc (&priv->mode_seq);
+  GST_DEBUG ("mode %d at %" GST_TIME_FORMAT "\n", mode, GST_TIME_ARGS (now));
+
+  synchronous_clock_arm_unlocked (my_clock);
+  UNLOCK_CLOCK (my_clock);
+}
+
+GstSynchronousClockMode
+gst_synchronous_clock_get_mode (GstClock *clock)
+{
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), DEFAULT_MODE);
+  return g_atomic_int_get (&GST_SYNCHRONOUSCLOCK (clock)->priv->mode);
+}
+
+/* Holds the time where it is: until the matching gst_synchronous_clock_unhold
+ * every advance, from any thread, blocks. When this returns no advance is
+ * in progress any more. Holds nest. The wall clock still moves the time in
+ * follow mode. */
+void
+gst_synchronous_clock_hold (GstClock *clock)
+{
+  GstSynchronousClock *my_clock;
+
+  g_return_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock));
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+
+  LOCK_CLOCK (my_clock);
+  g_atomic_int_inc (&my_clock->priv->hold);
+  while (g_atomic_int_get (&my_clock->priv->advancing) > 0)
+    g_cond_wait (&my_clock->priv->hold_cond, &my_clock->priv->mutex);
+  UNLOCK_CLOCK (my_clock);
+}
+
+void
+gst_synchronous_clock_unhold (GstClock *clock)
+{
+  GstSynchronousClock *my_clock;
+
+  g_return_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock));
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+  g_return_if_fail (g_atomic_int_get (&my_clock->priv->hold) > 0);
+
+  LOCK_CLOCK (my_clock);
+  g_atomic_int_add (&my_clock->priv->hold, -1);
+  g_cond_broadcast (&my_clock->priv->hold_cond);
+  UNLOCK_CLOCK (my_clock);
+}
+
+/* Makes 'follower' track this clock exactly: instead of the regression done
+ * by gst_clock_set_master, its calibration is re-anchored on each advance
+ * and, while following the wall clock, every 'tick'. */
+void
+gst_synchronous_clock_add_follower (GstClock *clock, GstClock *follower)
+{
+  GstSynchronousClock *my_clock;
+
+  g_return_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock));
+  g_return_if_fail (GST_IS_CLOCK (follower));
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+
+  gst_clock_set_master (follower, NULL);
+
+  LOCK_CLOCK (my_clock);
+  if (g_list_find (my_clock->priv->followers, follower) == NULL)
+    my_clock->priv->followers = g_list_append (my_clock->priv->followers,
+        gst_object_ref (follower));
+  synchronous_clock_arm_unlocked (my_clock);
+  UNLOCK_CLOCK (my_clock);
+
+  synchronous_clock_update_followers (my_clock);
+}
+
+void
+gst_synchronous_clock_remove_follower (GstClock *clock, GstClock *follower)
+{
+  GstSynchronousClock *my_clock;
+  GList *l;
+
+  g_return_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock));
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+
+  LOCK_CLOCK (my_clock);
+  l = g_list_find (my_clock->priv->followers, follower);
+  if (l != NULL)
+  {
+    my_clock->priv->followers = g_list_delete_link (
+        my_clock->priv->followers, l);
+    gst_object_unref (follower);
+    /* the last follower gone, stop waking up every tick */
+    synchronous_clock_arm_unlocked (my_clock);
+  }
+  UNLOCK_CLOCK (my_clock);
+}
+
+/* Adds the clock of every audio sink in 'bin' to the followers of 'clock'
+ * or removes it. Returns the number of sinks found. */
+static guint
+synchronous_clock_follow_audio_sinks (GstClock *clock, GstBin *bin,
+    gboolean follow)
+{
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+  gboolean done = FALSE;
+  guint n = 0;
+
+  it = gst_bin_iterate_recurse (bin);
+  while (!done)
+  {
+    switch (gst_iterator_next (it, &item))
+    {
+      case GST_ITERATOR_OK:
+      {
+        GstElement *element = g_value_get_object (&item);
+        if (GST_IS_AUDIO_BASE_SINK (element) 
+            && GST_AUDIO_BASE_SINK (element)->provided_clock != NULL)
+        {
+          GstClock *sink_clock = 
+              GST_AUDIO_BASE_SINK (element)->provided_clock;
+
+          if (follow)
+          {
+            g_object_set (G_OBJECT (element), "slave-method", 
+                GST_AUDIO_BASE_SINK_SLAVE_NONE, NULL);
+            gst_synchronous_clock_add_follower (clock, sink_clock);
+          }
+          else
+            gst_synchronous_clock_remove_follower (clock, sink_clock);
+          n++;
+        }
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        /* adding or removing a follower twice is harmless, only the count
+         * restarts */
+        gst_iterator_resync (it);
+        n = 0;
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return n;
+}
+
+/* Makes the clock of every audio sink in 'bin' a follower of 'clock' and
+ * turns off the sinks' own slaving, so they neither resample nor skip to
+ * correct drift against it. The clock keeps a reference on each follower,
+ * so undo this with gst_synchronous_clock_unfollow_audio_sinks before
+ * tearing 'bin' down. Returns the number of sinks found. */
+guint
+gst_synchronous_clock_follow_audio_sinks (GstClock *clock, GstBin *bin)
+{
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), 0);
+  g_return_val_if_fail (GST_IS_BIN (bin), 0);
+
+  return synchronous_clock_follow_audio_sinks (clock, bin, TRUE);
+}
+
+/* Removes the clock of every audio sink in 'bin' from the followers of
+ * 'clock'. The sinks' slave-method is left as it is. Returns the number of
+ * sinks found. */
+guint
+gst_synchronous_clock_unfollow_audio_sinks (GstClock *clock, GstBin *bin)
+{
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), 0);
+  g_return_val_if_fail (GST_IS_BIN (bin), 0);
+
+  return synchronous_clock_follow_audio_sinks (clock, bin, FALSE);
+}
+
+/* Copies up to 'n' records, oldest first, starting at '*cursor' (0 for the
+ * oldest one still kept) and moves the cursor past them. Records that were
+ * overwritten before or while being copied are dropped; a record still
+ * being written ends the read, the next one resumes from it. */
+guint
+gst_synchronous_clock_read_timeline (GstClock *clock, uint64_t *cursor,
+    GstSynchronousClockRecord *records, guint n)
+{
+  GstSynchronousClockPrivate *priv;
+  uint64_t head, seq;
+  guint count = 0;
+
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), 0);
+  g_return_val_if_fail (cursor != NULL, 0);
+  priv = GST_SYNCHRONOUSCLOCK (clock)->priv;
+
+  if (priv->timeline == NULL)
+    return 0;
+
+  head = ATOMIC_GET (&priv->timeline_head);
+  seq = head > priv->timeline_size ? head - priv->timeline_size : 0;
+  for (seq = MAX (*cursor, seq); seq < head && count < n; seq++)
+  {
+    SynchronousClockSlot *slot = &priv->timeline[seq % priv->timeline_size];
+    uint64_t stamp = ATOMIC_GET (&slot->stamp);
+
+    if (stamp == seq + 1)
+    {
+      records[count] = slot->record;
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+      stamp = ATOMIC_GET (&slot->stamp);
+      if (stamp == seq + 1)
+      {
+        count++;
+        continue;
+      }
+    }
+
+    /* not written yet, unless a newer record has claimed the slot */
+    if ((stamp == STAMP_BUSY || stamp < seq + 1)
+        && ATOMIC_GET (&priv->timeline_head) <= seq + priv->timeline_size)
+      break;
+  }
+
+  *cursor = seq;
+  return count;
+}
+
+/* Writes every record still kept to 'stream', either as CSV with a header
+ * line or as the raw records in host byte order. */
+gboolean
+gst_synchronous_clock_dump_timeline (GstClock *clock, GOutputStream *stream,
+    GstSynchronousClockDumpFormat format, GError **error)
+{
+  GstSynchronousClockRecord records[DUMP_CHUNK];
+  uint64_t cursor = 0, last;
+  guint n, i;
+
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), FALSE);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+
+  if (format == GST_SYNCHRONOUS_CLOCK_DUMP_CSV
+      && !g_output_stream_printf (stream, NULL, NULL, error,
+        "time,wall_time,released,source\n"))
+    return FALSE;
+
+  /* a read may return nothing yet move on, past overwritten records */
+  do
+  {
+    last = cursor;
+    n = gst_synchronous_clock_read_timeline (clock, &cursor, records,
+        DUMP_CHUNK);
+    if (format == GST_SYNCHRONOUS_CLOCK_DUMP_BINARY)
+    {
+      if (!g_output_stream_write_all (stream, records, 
+            n * sizeof (GstSynchronousClockRecord), NULL, NULL, error))
+        return FALSE;
+      continue;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+      if (!g_output_stream_printf (stream, NULL, NULL, error,
+            "%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",%u,%u\n",
+            (guint64) records[i].time, (guint64) records[i].wall_time,
+            records[i].released, records[i].source))
+        return FALSE;
+    }
+  } while (cursor != last);
+
+  return TRUE;
+}
+
+/* Waits up to 'timeout' ns of real time for an entry to be pending and
+ * returns when the earliest one is due (coalesce window included), or
+ * GST_CLOCK_TIME_NONE if nothing was scheduled in the meantime. */
+GstClockTime
+gst_synchronous_clock_wait_next_deadline (GstClock *clock, 
+    GstClockTime timeout)
+{
+  return gst_synchronous_clock_wait_quiet_deadline (clock, timeout, 0);
+}
+
+/* Like gst_synchronous_clock_wait_next_deadline, but once an entry is
+ * pending it keeps waiting until no entry has been scheduled for 'quiet'
+ * ns of real time. A controller jumping to the deadline then lets every
+ * branch of a pipeline block first, instead of moving the time past
+ * buffers that a slower branch has not delivered yet. */
+GstClockTime
+gst_synchronous_clock_wait_quiet_deadline (GstClock *clock, 
+    GstClockTime timeout, GstClockTime quiet)
+{
+  GstSynchronousClock *my_clock;
+  GstClockTime deadline = GST_CLOCK_TIME_NONE;
+  gint64 end_time;
+  guint64 queued;
+
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK(clock), GST_CLOCK_TIME_NONE);
+  my_clock = GST_SYNCHRONOUSCLOCK (clock);
+  end_time = g_get_monotonic_time () + (gint64) (timeout / GST_USECOND);
+
+  LOCK_CLOCK (my_clock);
+  while (my_clock->priv->waiters == NULL)
+  {
+    if (!g_cond_wait_until (&my_clock->priv->pending_cond, 
+          &my_clock->priv->mutex, end_time))
+      break;
+  }
+
+  /* each new entry restarts the quiet period */
+  do
+  {
+    queued = my_clock->priv->n_queued;
+    end_time = g_get_monotonic_time () + (gint64) (quiet / GST_USECOND);
+    while (my_clock->priv->waiters != NULL 
+        && my_clock->priv->n_queued == queued
+        && g_cond_wait_until (&my_clock->priv->pending_cond, 
+          &my_clock->priv->mutex, end_time))
+      ;
+  } while (my_clock->priv->n_queued != queued);
+
+  if (my_clock->priv->waiters != NULL)
+  {
+    SynchronousClockWaiter *head = my_clock->priv->waiters->data;
+    deadline = GST_CLOCK_ENTRY_TIME (head->entry) + my_clock->coalesce_window;
+  }
+  UNLOCK_CLOCK (my_clock);
+
+  return deadline;
+}
+
 /* PACKAGE: this is usually set by autotools depending on some _INIT macro
  * in configure.ac and then written into and defined in config.h, but we can
  * just set it ourselves here in case someone doesn't use autotools to
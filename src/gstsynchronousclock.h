@@ -66,6 +66,44 @@ G_BEGIN_DECLS
 #define GST_IS_SYNCHRONOUSCLOCK_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SYNCHRONOUSCLOCK))
 
+#define GST_TYPE_SYNCHRONOUSCLOCK_MODE \
+  (gst_synchronous_clock_mode_get_type())
+
+typedef enum
+{
+  GST_SYNCHRONOUS_CLOCK_MODE_MANUAL,  /* time moves only when advanced */
+  GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW   /* time follows the monotonic clock */
+} GstSynchronousClockMode;
+
+/* Who advanced the time, as recorded in the timeline. Applications may
+ * pass their own values, from GST_SYNCHRONOUS_CLOCK_SOURCE_USER on, to
+ * gst_synchronous_clock_advance_time_from. */
+typedef enum
+{
+  GST_SYNCHRONOUS_CLOCK_SOURCE_API,         /* advance_time */
+  GST_SYNCHRONOUS_CLOCK_SOURCE_TICK_FOR,    /* tick_for */
+  GST_SYNCHRONOUS_CLOCK_SOURCE_WALL_CLOCK,  /* entries due while following */
+  GST_SYNCHRONOUS_CLOCK_SOURCE_USER = 16
+} GstSynchronousClockSource;
+
+typedef enum
+{
+  GST_SYNCHRONOUS_CLOCK_DUMP_CSV,
+  GST_SYNCHRONOUS_CLOCK_DUMP_BINARY
+} GstSynchronousClockDumpFormat;
+
+/* One advance of the clock, or one wake-up while following the wall clock.
+ * 'released' counts the entries released by the release passes the
+ * advancing thread made; an advance whose release was taken over by a
+ * concurrent one records 0 and those entries count for the other one. */
+typedef struct
+{
+  uint64_t time;        /* clock time */
+  uint64_t wall_time;   /* monotonic time */
+  uint32_t released;    /* number of entries released */
+  uint32_t source;      /* GstSynchronousClockSource */
+} GstSynchronousClockRecord;
+
 typedef struct _GstSynchronousClock          GstSynchronousClock;
 typedef struct _GstSynchronousClockClass     GstSynchronousClockClass;
 typedef struct _GstSynchronousClockPrivate   GstSynchronousClockPrivate;
@@ -76,6 +114,8 @@ struct _GstSynchronousClock
   GstSynchronousClockPrivate *priv;
 
   uint64_t tick;
+  uint64_t coalesce_window;
+  uint64_t max_latency;
 };
 
 struct _GstSynchronousClockClass 
@@ -86,15 +126,60 @@ struct _GstSynchronousClockClass
 GType 
 gst_synchronous_clock_get_type (void);
 
+GType
+gst_synchronous_clock_mode_get_type (void);
+
 GstClock *
 gst_synchronous_clock_new ();
 
 gboolean
 gst_synchronous_clock_advance_time (GstClock *,  uint64_t);
 
+gboolean
+gst_synchronous_clock_advance_time_from (GstClock *,  uint64_t, guint);
+
 void
 gst_synchronous_clock_tick_for (GstClock *, uint64_t, GCancellable *);
 
+void
+gst_synchronous_clock_set_mode (GstClock *, GstSynchronousClockMode);
+
+GstSynchronousClockMode
+gst_synchronous_clock_get_mode (GstClock *);
+
+GstClockTime
+gst_synchronous_clock_wait_next_deadline (GstClock *, GstClockTime);
+
+GstClockTime
+gst_synchronous_clock_wait_quiet_deadline (GstClock *, GstClockTime,
+    GstClockTime);
+
+void
+gst_synchronous_clock_hold (GstClock *);
+
+void
+gst_synchronous_clock_unhold (GstClock *);
+
+void
+gst_synchronous_clock_add_follower (GstClock *, GstClock *);
+
+void
+gst_synchronous_clock_remove_follower (GstClock *, GstClock *);
+
+guint
+gst_synchronous_clock_follow_audio_sinks (GstClock *, GstBin *);
+
+guint
+gst_synchronous_clock_unfollow_audio_sinks (GstClock *, GstBin *);
+
+guint
+gst_synchronous_clock_read_timeline (GstClock *, uint64_t *,
+    GstSynchronousClockRecord *, guint);
+
+gboolean
+gst_synchronous_clock_dump_timeline (GstClock *, GOutputStream *,
+    GstSynchronousClockDumpFormat, GError **);
+
 G_END_DECLS
 
 #endif /* __GST_SYNCHRONOUSCLOCK_H__ */
@@ -0,0 +1,218 @@
+/*
+ * GStreamer
+ * Copyright (C) 2005 Thomas Vander Stichele <thomas@apestaart.org>
+ * Copyright (C) 2005 Ronald S. Bultje <rbultje@ronald.bitfreak.net>
+ * Copyright (C) 2016 Rodrigo Costa <rodrigocosta@telemidia.puc-rio.br>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * Alternatively, the contents of this file may be used under the
+ * GNU Lesser General Public License Version 2.1 (the "LGPL"), in
+ * which case the following provisions apply instead of the ones
+ * mentioned above:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Starting a scene of many pipelines one after the other makes each one
+ * preroll in turn. A group prerolls all of them at once on a thread pool
+ * while the clock is held at a common base time, then sets them PLAYING
+ * together, so startup takes as long as the slowest pipeline. */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <gst/gst.h>
+#include "gstsynchronousclockgroup.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_synchronous_clock_group_debug);
+#define GST_CAT_DEFAULT gst_synchronous_clock_group_debug
+
+struct _GstSynchronousClockGroup
+{
+  GstClock *clock;
+  gint max_threads;
+  GPtrArray *pipelines;
+
+  /* set while starting */
+  GstClockTime timeout;
+  gint failed;
+};
+
+/* 'max_threads' bounds how many pipelines preroll at the same time, -1
+ * meaning all of them; it must not be 0 */
+GstSynchronousClockGroup *
+gst_synchronous_clock_group_new (GstClock *clock, gint max_threads)
+{
+  GstSynchronousClockGroup *group;
+
+  g_return_val_if_fail (GST_IS_SYNCHRONOUSCLOCK (clock), NULL);
+  /* with no thread at all, nothing would ever preroll */
+  g_return_val_if_fail (max_threads == -1 || max_threads > 0, NULL);
+
+  GST_DEBUG_CATEGORY_INIT (gst_synchronous_clock_group_debug, 
+      "synchronousclockgroup", 0, "Synchronous clock group");
+
+  group = g_new0 (GstSynchronousClockGroup, 1);
+  group->clock = gst_object_ref (clock);
+  group->max_threads = max_threads;
+  group->pipelines = g_ptr_array_new_with_free_func (gst_object_unref);
+
+  return group;
+}
+
+void
+gst_synchronous_clock_group_free (GstSynchronousClockGroup *group)
+{
+  g_return_if_fail (group != NULL);
+
+  g_ptr_array_unref (group->pipelines);
+  gst_object_unref (group->clock);
+  g_free (group);
+}
+
+void
+gst_synchronous_clock_group_add (GstSynchronousClockGroup *group, 
+    GstPipeline *pipeline)
+{
+  g_return_if_fail (group != NULL);
+  g_return_if_fail (GST_IS_PIPELINE (pipeline));
+
+  g_ptr_array_add (group->pipelines, gst_object_ref (pipeline));
+}
+
+static void
+synchronous_clock_group_preroll (gpointer data, gpointer user_data)
+{
+  GstElement *pipeline = GST_ELEMENT (data);
+  GstSynchronousClockGroup *group = user_data;
+  GstStateChangeReturn ret;
+
+  ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  if (ret == GST_STATE_CHANGE_ASYNC)
+    ret = gst_element_get_state (pipeline, NULL, NULL, group->timeout);
+
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC)
+  {
+    GST_WARNING_OBJECT (pipeline, "failed to preroll");
+    g_atomic_int_set (&group->failed, TRUE);
+  }
+}
+
+/* Prerolls every pipeline of the group in parallel, waiting up to 'timeout'
+ * for each one, and sets them all PLAYING with the same base time. The
+ * time is held meanwhile, so advances from other threads (tick_for, a
+ * synchronousclocksrc...) block until all of them are PLAYING; a single
+ * advance then releases what they scheduled at the base time, and a clock
+ * that was following the wall clock resumes. Each pipeline gets its start
+ * time back once started, so pausing and resuming it later works as usual.
+ * Returns FALSE, leaving the pipelines PAUSED, if any of them failed to
+ * preroll, or where they were if the preroll threads could not be
+ * created. */
+gboolean
+gst_synchronous_clock_group_start (GstSynchronousClockGroup *group, 
+    GstClockTime timeout)
+{
+  GstSynchronousClockMode mode;
+  GstClockTime base_time, *start_times;
+  GThreadPool *pool;
+  GError *error = NULL;
+  guint i;
+
+  g_return_val_if_fail (group != NULL, FALSE);
+
+  mode = gst_synchronous_clock_get_mode (group->clock);
+  gst_synchronous_clock_set_mode (group->clock, 
+      GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+  gst_synchronous_clock_hold (group->clock);
+  base_time = gst_clock_get_time (group->clock);
+
+  /* with no start time the pipelines keep the base time given here */
+  start_times = g_new (GstClockTime, group->pipelines->len);
+  for (i = 0; i < group->pipelines->len; i++)
+  {
+    GstElement *pipeline = g_ptr_array_index (group->pipelines, i);
+    start_times[i] = gst_element_get_start_time (pipeline);
+    gst_pipeline_use_clock (GST_PIPELINE (pipeline), group->clock);
+    gst_element_set_start_time (pipeline, GST_CLOCK_TIME_NONE);
+    gst_element_set_base_time (pipeline, base_time);
+  }
+
+  group->timeout = timeout;
+  group->failed = FALSE;
+  pool = g_thread_pool_new (synchronous_clock_group_preroll, group,
+      group->max_threads, FALSE, &error);
+  if (pool == NULL)
+  {
+    GST_ERROR ("could not create the preroll threads: %s", error->message);
+    g_error_free (error);
+    group->failed = TRUE;
+  }
+  else
+  {
+    for (i = 0; i < group->pipelines->len; i++)
+      g_thread_pool_push (pool, g_ptr_array_index (group->pipelines, i), 
+          NULL);
+
+    /* waits for every preroll to finish */
+    g_thread_pool_free (pool, FALSE, TRUE);
+  }
+
+  if (!g_atomic_int_get (&group->failed))
+  {
+    for (i = 0; i < group->pipelines->len; i++)
+    {
+      GstElement *pipeline = g_ptr_array_index (group->pipelines, i);
+      GstStateChangeReturn ret;
+
+      ret = gst_element_set_state (pipeline, GST_STATE_PLAYING);
+      if (ret == GST_STATE_CHANGE_ASYNC)
+        ret = gst_element_get_state (pipeline, NULL, NULL, timeout);
+      if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC)
+        group->failed = TRUE;
+    }
+  }
+
+  for (i = 0; i < group->pipelines->len; i++)
+    gst_element_set_start_time (g_ptr_array_index (group->pipelines, i),
+        start_times[i]);
+  g_free (start_times);
+
+  GST_DEBUG ("started %u pipelines at %" GST_TIME_FORMAT "\n", 
+      group->pipelines->len, GST_TIME_ARGS (base_time));
+
+  gst_synchronous_clock_unhold (group->clock);
+  gst_synchronous_clock_advance_time (group->clock, 0);
+  gst_synchronous_clock_set_mode (group->clock, mode);
+  return !group->failed;
+}
@@ -0,0 +1,478 @@
+/*
+ * GStreamer
+ * Copyright (C) 2005 Thomas Vander Stichele <thomas@apestaart.org>
+ * Copyright (C) 2005 Ronald S. Bultje <rbultje@ronald.bitfreak.net>
+ * Copyright (C) 2016 Rodrigo Costa <rodrigocosta@telemidia.puc-rio.br>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * Alternatively, the contents of this file may be used under the
+ * GNU Lesser General Public License Version 2.1 (the "LGPL"), in
+ * which case the following provisions apply instead of the ones
+ * mentioned above:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-synchronousclocksrc
+ *
+ * Provides a #GstSynchronousClock to the pipeline it is in, so pipelines
+ * written as launch lines can run on the synchronous clock. It has no pads.
+ * From READY to PAUSED the outermost pipeline it is in is made to use that
+ * clock with gst_pipeline_use_clock, so it wins over the clocks provided by
+ * other elements, such as audio sinks. Going back to READY returns the
+ * pipeline to automatic clock selection. A clock the application already
+ * fixed on the pipeline, e.g., with gst_synchronous_clock_group_start, is
+ * never replaced; the element's clock then goes unused.
+ *
+ * In real-time mode the clock runs 'rate' times as fast as the wall clock,
+ * in free-running mode it jumps straight to each pending deadline, running
+ * as fast as the pipeline can go, and in stepped mode it only moves when
+ * the application calls gst_synchronous_clock_advance_time on it.
+ * Whatever the mode, time stops while the pipeline is paused.
+ *
+ * Before each jump, free-running mode waits until no entry has been
+ * scheduled for 'quiet-period' of real time, so with several synchronised
+ * sinks (e.g., audio and video) every branch gets to block before time
+ * moves past it. This is a heuristic: a branch taking longer than that to
+ * deliver its next buffer still gets it late, so free-running is only
+ * strictly deterministic with a single synchronised sink.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 synchronousclocksrc mode=free-running \
+ *     videotestsrc num-buffers=300 ! fakesink sync=true
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <gst/gst.h>
+#include "gstsynchronousclocksrc.h"
+
+#define DEFAULT_MODE GST_SYNCHRONOUS_CLOCK_SRC_MODE_REAL_TIME
+#define DEFAULT_RATE 1.0
+#define DEFAULT_QUIET_PERIOD 2 * GST_MSECOND
+
+GST_DEBUG_CATEGORY_STATIC (gst_synchronous_clock_src_debug);
+#define GST_CAT_DEFAULT gst_synchronous_clock_src_debug
+
+enum
+{
+  PROP_TICK = 1,
+  PROP_MODE,
+  PROP_RATE,
+  PROP_QUIET_PERIOD,
+};
+
+G_DEFINE_TYPE (GstSynchronousClockSrc, gst_synchronous_clock_src,
+    GST_TYPE_ELEMENT)
+
+static void gst_synchronous_clock_src_set_property (GObject *, guint,
+    const GValue *, GParamSpec *);
+static void gst_synchronous_clock_src_get_property (GObject *, guint,
+    GValue *, GParamSpec *);
+static void synchronous_clock_src_finalize (GObject *);
+static GstClock *synchronous_clock_src_provide_clock (GstElement *);
+static GstStateChangeReturn synchronous_clock_src_change_state (GstElement *,
+    GstStateChange);
+
+GType
+gst_synchronous_clock_src_mode_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {GST_SYNCHRONOUS_CLOCK_SRC_MODE_REAL_TIME, 
+        "Time runs 'rate' times as fast as the wall clock", "real-time"},
+    {GST_SYNCHRONOUS_CLOCK_SRC_MODE_FREE_RUNNING,
+        "Time jumps to each pending deadline", "free-running"},
+    {GST_SYNCHRONOUS_CLOCK_SRC_MODE_STEPPED,
+        "Time is advanced by the application", "stepped"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id))
+  {
+    GType tmp = g_enum_register_static ("GstSynchronousClockSrcMode", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
+/* GObject vmethod implementations */
+
+static void
+gst_synchronous_clock_src_class_init (GstSynchronousClockSrcClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *element_class;
+
+  gobject_class = (GObjectClass *) klass;
+  element_class = (GstElementClass *) klass;
+
+  gobject_class->finalize = synchronous_clock_src_finalize;
+  gobject_class->set_property = gst_synchronous_clock_src_set_property;
+  gobject_class->get_property = gst_synchronous_clock_src_get_property;
+
+  element_class->provide_clock = synchronous_clock_src_provide_clock;
+  element_class->change_state = synchronous_clock_src_change_state;
+
+  g_object_class_install_property (gobject_class, PROP_TICK,
+      g_param_spec_uint64 ("tick", "Tick", "Real time between two advances "
+        "of the clock in real-time mode with a rate other than 1",
+          1, G_MAXUINT64, 32 * GST_MSECOND, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode", "How the provided clock advances. "
+        "Changes apply on the next PAUSED to PLAYING transition", 
+        GST_TYPE_SYNCHRONOUSCLOCKSRC_MODE, DEFAULT_MODE, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_RATE,
+      g_param_spec_double ("rate", "Rate", "Speed of the clock relative to "
+        "the wall clock in real-time mode", G_MINDOUBLE, G_MAXDOUBLE, 
+          DEFAULT_RATE, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_QUIET_PERIOD,
+      g_param_spec_uint64 ("quiet-period", "Quiet period", "Real time "
+        "during which no entry may be scheduled before free-running mode "
+        "jumps to the next deadline (0 = jump right away)", 0, G_MAXUINT64,
+          DEFAULT_QUIET_PERIOD, G_PARAM_READWRITE));
+
+  gst_element_class_set_static_metadata (element_class,
+      "Synchronous clock source", "Generic",
+      "Provides a deterministic clock to the pipeline",
+      "Rodrigo Costa <rodrigocosta@telemidia.puc-rio.br>");
+
+  GST_DEBUG_CATEGORY_INIT (gst_synchronous_clock_src_debug, 
+      "synchronousclocksrc", 0, "Synchronous clock source");
+}
+
+static void
+gst_synchronous_clock_src_init (GstSynchronousClockSrc * self)
+{
+  self->clock = gst_object_ref_sink (gst_synchronous_clock_new ());
+  self->mode = DEFAULT_MODE;
+  self->rate = DEFAULT_RATE;
+  self->quiet_period = DEFAULT_QUIET_PERIOD;
+  GST_OBJECT_FLAG_SET (self, GST_ELEMENT_FLAG_PROVIDE_CLOCK);
+}
+
+static void
+synchronous_clock_src_finalize (GObject *object)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (object);
+  gst_object_unref (self->clock);
+
+  G_OBJECT_CLASS (gst_synchronous_clock_src_parent_class)->finalize(object);
+}
+
+static void
+gst_synchronous_clock_src_set_property (GObject *object, guint prop_id,
+    const GValue *value, GParamSpec *pspec)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (object);
+
+  switch (prop_id)
+  {
+    case PROP_TICK:
+    {
+      g_object_set_property (G_OBJECT (self->clock), "tick", value);
+      break;
+    }
+    case PROP_MODE:
+    {
+      GST_OBJECT_LOCK (self);
+      self->mode = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_RATE:
+    {
+      GST_OBJECT_LOCK (self);
+      self->rate = g_value_get_double (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_QUIET_PERIOD:
+    {
+      GST_OBJECT_LOCK (self);
+      self->quiet_period = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_synchronous_clock_src_get_property (GObject * object, guint prop_id,
+    GValue *value, GParamSpec *pspec)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (object);
+
+  switch (prop_id)
+  {
+    case PROP_TICK:
+    {
+      g_object_get_property (G_OBJECT (self->clock), "tick", value);
+      break;
+    }
+    case PROP_MODE:
+    {
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, self->mode);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_RATE:
+    {
+      GST_OBJECT_LOCK (self);
+      g_value_set_double (value, self->rate);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_QUIET_PERIOD:
+    {
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->quiet_period);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/* GstElement vmethod implementations */
+
+static GstClock *
+synchronous_clock_src_provide_clock (GstElement *element)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (element);
+  return gst_object_ref (self->clock);
+}
+
+/* Finds the outermost pipeline the element is in, the one that selects the
+ * clock, or NULL if there is none */
+static GstPipeline *
+synchronous_clock_src_find_pipeline (GstSynchronousClockSrc *self)
+{
+  GstObject *object, *parent;
+  GstPipeline *pipeline = NULL;
+
+  object = gst_object_ref (self);
+  while ((parent = gst_object_get_parent (object)) != NULL)
+  {
+    gst_object_unref (object);
+    object = parent;
+    if (GST_IS_PIPELINE (object))
+    {
+      if (pipeline != NULL)
+        gst_object_unref (pipeline);
+      pipeline = GST_PIPELINE (gst_object_ref (object));
+    }
+  }
+  gst_object_unref (object);
+
+  return pipeline;
+}
+
+/* Drives the clock while PLAYING, in the modes that need a thread */
+static gpointer
+synchronous_clock_src_loop (gpointer data)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (data);
+  GstClock *internal_clock = gst_system_clock_obtain ();
+  uint64_t tick = GST_SYNCHRONOUSCLOCK (self->clock)->tick;
+
+  GST_OBJECT_LOCK (self);
+  while (self->running)
+  {
+    if (self->mode == GST_SYNCHRONOUS_CLOCK_SRC_MODE_FREE_RUNNING)
+    {
+      GstClockTime deadline, now, quiet = self->quiet_period;
+
+      /* 'tick' only bounds how long stopping the thread can take here */
+      GST_OBJECT_UNLOCK (self);
+      deadline = gst_synchronous_clock_wait_quiet_deadline (self->clock, tick,
+          quiet);
+      if (GST_CLOCK_TIME_IS_VALID (deadline))
+      {
+        now = gst_clock_get_time (self->clock);
+        gst_synchronous_clock_advance_time (self->clock, 
+            deadline > now ? deadline - now : 0);
+      }
+      GST_OBJECT_LOCK (self);
+    }
+    else
+    {
+      GstClockID clock_id;
+      uint64_t step = (uint64_t) (tick * self->rate);
+
+      clock_id = gst_clock_new_single_shot_id (internal_clock,
+          gst_clock_get_time (internal_clock) + tick);
+      self->sleep_id = clock_id;
+      GST_OBJECT_UNLOCK (self);
+
+      gst_synchronous_clock_advance_time (self->clock, step);
+      gst_clock_id_wait (clock_id, NULL);
+
+      GST_OBJECT_LOCK (self);
+      self->sleep_id = NULL;
+      gst_clock_id_unref (clock_id);
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  gst_object_unref (internal_clock);
+  return NULL;
+}
+
+static void
+synchronous_clock_src_start (GstSynchronousClockSrc *self)
+{
+  gboolean need_thread;
+
+  GST_OBJECT_LOCK (self);
+  need_thread = self->mode == GST_SYNCHRONOUS_CLOCK_SRC_MODE_FREE_RUNNING
+      || (self->mode == GST_SYNCHRONOUS_CLOCK_SRC_MODE_REAL_TIME 
+          && self->rate != 1.0);
+
+  /* real time at rate 1 is just following the wall clock, no thread needed */
+  if (self->mode == GST_SYNCHRONOUS_CLOCK_SRC_MODE_REAL_TIME && !need_thread)
+    gst_synchronous_clock_set_mode (self->clock, 
+        GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW);
+
+  if (need_thread)
+  {
+    self->running = TRUE;
+    self->thread = g_thread_new ("synchronousclocksrc", 
+        synchronous_clock_src_loop, self);
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+synchronous_clock_src_stop (GstSynchronousClockSrc *self)
+{
+  GThread *thread;
+
+  GST_OBJECT_LOCK (self);
+  self->running = FALSE;
+  if (self->sleep_id != NULL)
+    gst_clock_id_unschedule (self->sleep_id);
+  thread = self->thread;
+  self->thread = NULL;
+  GST_OBJECT_UNLOCK (self);
+
+  if (thread != NULL)
+    g_thread_join (thread);
+
+  gst_synchronous_clock_set_mode (self->clock, 
+      GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+}
+
+static GstStateChangeReturn
+synchronous_clock_src_change_state (GstElement *element,
+    GstStateChange transition)
+{
+  GstSynchronousClockSrc *self = GST_SYNCHRONOUSCLOCKSRC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition)
+  {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+    {
+      /* providing the clock alone loses to any provider nearer the sinks,
+       * but a clock fixed by the application (or a group) is left alone */
+      GstPipeline *pipeline = synchronous_clock_src_find_pipeline (self);
+      if (pipeline != NULL 
+          && GST_OBJECT_FLAG_IS_SET (pipeline, GST_PIPELINE_FLAG_FIXED_CLOCK))
+      {
+        GST_WARNING_OBJECT (self, "%s already uses a fixed clock, not "
+            "replacing it", GST_OBJECT_NAME (pipeline));
+        gst_object_unref (pipeline);
+        pipeline = NULL;
+      }
+      if (pipeline != NULL)
+        gst_pipeline_use_clock (pipeline, self->clock);
+      GST_OBJECT_LOCK (self);
+      self->pipeline = pipeline;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      synchronous_clock_src_start (self);
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      synchronous_clock_src_stop (self);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (gst_synchronous_clock_src_parent_class)->
+      change_state (element, transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+  {
+    GstPipeline *pipeline;
+    gboolean fixed;
+
+    GST_OBJECT_LOCK (self);
+    pipeline = self->pipeline;
+    self->pipeline = NULL;
+    GST_OBJECT_UNLOCK (self);
+
+    if (pipeline != NULL)
+    {
+      /* unless the application has fixed another clock in the meantime */
+      GST_OBJECT_LOCK (pipeline);
+      fixed = pipeline->fixed_clock == self->clock;
+      GST_OBJECT_UNLOCK (pipeline);
+      if (fixed)
+        gst_pipeline_auto_clock (pipeline);
+      gst_object_unref (pipeline);
+    }
+  }
+
+  return ret;
+}
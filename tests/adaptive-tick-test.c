@@ -0,0 +1,78 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+
+#define MS_TO_NS 1000000
+
+static GstClockTime released_at = GST_CLOCK_TIME_NONE;
+static gint64 released_wall = 0;
+
+static gboolean
+release_cb (GstClock *clock, GstClockTime time, GstClockID id, 
+    gpointer user_data)
+{
+  released_at = gst_clock_get_time (clock);
+  released_wall = g_get_monotonic_time ();
+  return TRUE;
+}
+
+/* schedules an entry 20ms ahead while tick_for sleeps a 100ms step */
+static gpointer
+schedule_late (gpointer data)
+{
+  GstClock *clock = data;
+  GstClockID clock_id;
+
+  g_usleep (10000);
+  clock_id = gst_clock_new_single_shot_id (clock, 
+      gst_clock_get_time (clock) + 20 * MS_TO_NS);
+  gst_clock_id_wait_async (clock_id, release_cb, NULL, NULL);
+  return clock_id;
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock;
+  GstClockID clock_id;
+  guint64 tick;
+  gint64 start;
+  GThread *thread;
+
+  gst_init (&argc, &argv);
+
+  clock = gst_synchronous_clock_new ();
+  g_assert (clock);
+  g_object_set (G_OBJECT (clock), "max-latency", (guint64) 100 * MS_TO_NS, 
+      NULL);
+
+  clock_id = gst_clock_new_single_shot_id (clock, 30 * MS_TO_NS);
+  gst_clock_id_wait_async (clock_id, release_cb, NULL, NULL);
+
+  start = g_get_monotonic_time ();
+  gst_synchronous_clock_tick_for (clock, 200 * MS_TO_NS, NULL);
+  g_assert (gst_clock_get_time (clock) == 200 * MS_TO_NS);
+
+  /* stepped right onto the deadline instead of a multiple of 'tick' */
+  g_assert (released_at == 30 * MS_TO_NS);
+
+  /* the step was slept before being advanced, so never released early */
+  g_assert (released_wall - start >= 30 * MS_TO_NS / GST_USECOND);
+
+  /* then 100ms (max-latency) and the remaining 70ms */
+  g_object_get (G_OBJECT (clock), "current-tick", &tick, NULL);
+  g_assert (tick == 70 * MS_TO_NS);
+
+  gst_clock_id_unref (clock_id);
+
+  /* an entry scheduled during a step cuts it short instead of being
+   * overshot by up to max-latency */
+  released_at = GST_CLOCK_TIME_NONE;
+  thread = g_thread_new ("schedule", schedule_late, clock);
+  gst_synchronous_clock_tick_for (clock, 200 * MS_TO_NS, NULL);
+  clock_id = g_thread_join (thread);
+  g_assert (gst_clock_get_time (clock) == 400 * MS_TO_NS);
+  g_assert (released_at == 220 * MS_TO_NS);
+
+  gst_clock_id_unref (clock_id);
+  g_object_unref (clock);
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+
+/* An element providing the system clock, competing with the element */
+typedef GstElement TestClockProvider;
+typedef GstElementClass TestClockProviderClass;
+
+G_DEFINE_TYPE (TestClockProvider, test_clock_provider, GST_TYPE_ELEMENT)
+
+static GstClock *
+test_clock_provider_provide_clock (GstElement *element)
+{
+  return gst_system_clock_obtain ();
+}
+
+static void
+test_clock_provider_class_init (TestClockProviderClass *klass)
+{
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  element_class->provide_clock = test_clock_provider_provide_clock;
+  gst_element_class_set_static_metadata (element_class,
+      "Test clock provider", "Generic", "Provides the system clock",
+      "Rodrigo Costa <rodrigocosta@telemidia.puc-rio.br>");
+}
+
+static void
+test_clock_provider_init (TestClockProvider *self)
+{
+  GST_OBJECT_FLAG_SET (self, GST_ELEMENT_FLAG_PROVIDE_CLOCK);
+}
+
+static void
+handoff_cb (GstElement *sink, GstBuffer *buffer, GstPad *pad, 
+    gpointer user_data)
+{
+  g_atomic_int_inc ((gint *) user_data);
+}
+
+/* Two branches at different rates, each buffer dropped if at all late */
+static void
+test_two_sinks (void)
+{
+  GstElement *pipeline, *sink;
+  GstBus *bus;
+  GstMessage *msg;
+  gint rendered[2] = {0, 0};
+  const gchar *names[2] = {"a", "b"};
+  int i;
+
+  pipeline = gst_parse_launch ("synchronousclocksrc mode=free-running "
+      "fakesrc num-buffers=50 format=time sizetype=fixed sizemax=100 "
+      "datarate=1000 ! fakesink name=a sync=true max-lateness=0 "
+      "signal-handoffs=true "
+      "fakesrc num-buffers=50 format=time sizetype=fixed sizemax=100 "
+      "datarate=700 ! fakesink name=b sync=true max-lateness=0 "
+      "signal-handoffs=true", NULL);
+  g_assert (pipeline);
+
+  for (i = 0; i < 2; i++)
+  {
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), names[i]);
+    g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), &rendered[i]);
+    gst_object_unref (sink);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, 5 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  g_assert (msg != NULL);
+  g_assert (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  /* time never jumped past a buffer the other branch had yet to deliver */
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_assert (g_atomic_int_get (&rendered[0]) == 50);
+  g_assert (g_atomic_int_get (&rendered[1]) == 50);
+
+  gst_object_unref (pipeline);
+}
+
+int main(int argc, char *argv[])
+{
+  GstElement *pipeline;
+  GstElementFactory *factory;
+  GstClock *clock;
+  GstBus *bus;
+  GstMessage *msg;
+  GError *error = NULL;
+  gint64 t;
+
+  gst_init (&argc, &argv);
+
+  /* the element comes from the plugin, as in any launch line */
+  gst_registry_scan_path (gst_registry_get (), PLUGIN_DIR);
+  factory = gst_element_factory_find ("synchronousclocksrc");
+  g_assert (factory != NULL);
+  gst_object_unref (factory);
+  gst_element_register (NULL, "testclockprovider", GST_RANK_NONE,
+      test_clock_provider_get_type ());
+
+  /* ten seconds of buffers */
+  pipeline = gst_parse_launch ("synchronousclocksrc mode=free-running "
+      "testclockprovider fakesrc num-buffers=100 format=time sizetype=fixed "
+      "sizemax=100 datarate=1000 ! fakesink sync=true", &error);
+  g_assert (pipeline);
+  g_assert (error == NULL);
+
+  t = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, 5 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  g_assert (msg != NULL);
+  g_assert (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  /* the synchronous clock won and ran free, well ahead of the wall clock */
+  clock = gst_pipeline_get_pipeline_clock (GST_PIPELINE (pipeline));
+  g_assert (GST_IS_SYNCHRONOUSCLOCK (clock));
+  g_assert (g_get_monotonic_time () - t < 5 * G_USEC_PER_SEC);
+  gst_object_unref (clock);
+
+  /* back to automatic clock selection once out of PAUSED */
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_assert (!GST_OBJECT_FLAG_IS_SET (pipeline, GST_PIPELINE_FLAG_FIXED_CLOCK));
+
+  /* a clock fixed by the application is neither replaced nor lost */
+  clock = gst_system_clock_obtain ();
+  gst_pipeline_use_clock (GST_PIPELINE (pipeline), clock);
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+  g_assert (GST_PIPELINE (pipeline)->fixed_clock == clock);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_assert (GST_OBJECT_FLAG_IS_SET (pipeline, GST_PIPELINE_FLAG_FIXED_CLOCK));
+  g_assert (GST_PIPELINE (pipeline)->fixed_clock == clock);
+  gst_object_unref (clock);
+
+  gst_object_unref (pipeline);
+
+  test_two_sinks ();
+  return 0;
+}
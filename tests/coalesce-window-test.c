@@ -0,0 +1,57 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+
+static GstClockTime released[3];
+static guint n_released = 0;
+
+static gboolean
+release_cb (GstClock *clock, GstClockTime time, GstClockID id, 
+    gpointer user_data)
+{
+  released[n_released++] = time;
+  return TRUE;
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock;
+  GstClockID ids[3];
+  GstClockTime deadlines[3] = { 1000, 1300, 1600 };
+  int i;
+
+  gst_init (&argc, &argv);
+
+  clock = gst_synchronous_clock_new ();
+  g_assert (clock);
+  g_object_set (G_OBJECT (clock), "coalesce-window", (guint64) 500, NULL);
+
+  /* scheduled out of order, released in deadline order */
+  for (i = 2; i >= 0; i--)
+  {
+    ids[i] = gst_clock_new_single_shot_id (clock, deadlines[i]);
+    g_assert (gst_clock_id_wait_async (ids[i], release_cb, NULL, NULL) 
+        == GST_CLOCK_OK);
+  }
+
+  /* 1000 is due but still inside the window */
+  gst_synchronous_clock_advance_time (clock, 1200);
+  g_assert (n_released == 0);
+
+  /* 1000 and 1300 go out together */
+  gst_synchronous_clock_advance_time (clock, 300);
+  g_assert (n_released == 2);
+  g_assert (released[0] == 1000);
+  g_assert (released[1] == 1300);
+
+  gst_synchronous_clock_advance_time (clock, 500);
+  g_assert (n_released == 2);
+
+  gst_synchronous_clock_advance_time (clock, 100);
+  g_assert (n_released == 3);
+  g_assert (released[2] == 1600);
+
+  for (i = 0; i < 3; i++)
+    gst_clock_id_unref (ids[i]);
+  g_object_unref (clock);
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+
+#define N_THREADS 4
+#define N_ADVANCES 10000
+#define N_ENTRIES 100
+#define STEP 1000
+
+static gint n_released = 0;
+
+static gboolean
+release_cb (GstClock *clock, GstClockTime time, GstClockID id, 
+    gpointer user_data)
+{
+  g_atomic_int_inc (&n_released);
+  return TRUE;
+}
+
+static gpointer
+advance_thread (gpointer data)
+{
+  GstClock *clock = GST_CLOCK (data);
+  GstClockTime last = 0;
+  int i;
+
+  for (i = 0; i < N_ADVANCES; i++)
+  {
+    GstClockTime now;
+    gst_synchronous_clock_advance_time (clock, STEP);
+    now = gst_clock_get_time (clock);
+    g_assert (now >= last);
+    last = now;
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock;
+  GstClockID ids[N_ENTRIES];
+  GThread *threads[N_THREADS];
+  int i;
+
+  gst_init (&argc, &argv);
+
+  clock = gst_synchronous_clock_new ();
+  g_assert (clock);
+
+  for (i = 0; i < N_ENTRIES; i++)
+  {
+    ids[i] = gst_clock_new_single_shot_id (clock, 
+        (i + 1) * (GstClockTime) N_THREADS * N_ADVANCES * STEP / N_ENTRIES);
+    gst_clock_id_wait_async (ids[i], release_cb, NULL, NULL);
+  }
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("advance", advance_thread, clock);
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* every advance counted and every entry released */
+  g_assert (gst_clock_get_time (clock) 
+      == (GstClockTime) N_THREADS * N_ADVANCES * STEP);
+  g_assert (g_atomic_int_get (&n_released) == N_ENTRIES);
+
+  for (i = 0; i < N_ENTRIES; i++)
+    gst_clock_id_unref (ids[i]);
+  g_object_unref (clock);
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+
+#define SLEEP 20000 /* us */
+#define SWITCHES 200
+
+static gboolean done = FALSE;
+
+static gpointer
+read_loop (gpointer data)
+{
+  GstClock *clock = data;
+
+  while (!g_atomic_int_get (&done))
+    gst_clock_get_time (clock);
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock;
+  GstClockID clock_id;
+  GstClockTime t1, t2;
+  GThread *reader;
+  int i;
+
+  gst_init (&argc, &argv);
+
+  clock = gst_synchronous_clock_new ();
+  g_assert (clock);
+  g_assert (gst_synchronous_clock_get_mode (clock) 
+      == GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+
+  gst_synchronous_clock_advance_time (clock, GST_SECOND);
+  g_assert (gst_clock_get_time (clock) == GST_SECOND);
+
+  /* resume: time follows the wall clock from where it was */
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW);
+  t1 = gst_clock_get_time (clock);
+  g_assert (t1 >= GST_SECOND);
+  g_usleep (SLEEP);
+  t2 = gst_clock_get_time (clock);
+  g_assert (t2 >= t1 + SLEEP * GST_USECOND);
+
+  /* entries are released without anyone advancing the time */
+  clock_id = gst_clock_new_single_shot_id (clock, t2 + SLEEP * GST_USECOND);
+  g_assert (gst_clock_id_wait (clock_id, NULL) == GST_CLOCK_OK);
+  gst_clock_id_unref (clock_id);
+
+  /* pause: time stops, never going backwards */
+  t1 = gst_clock_get_time (clock);
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+  t2 = gst_clock_get_time (clock);
+  g_assert (t2 >= t1);
+  g_usleep (SLEEP);
+  g_assert (gst_clock_get_time (clock) == t2);
+
+  /* step */
+  gst_synchronous_clock_advance_time (clock, 1000);
+  g_assert (gst_clock_get_time (clock) == t2 + 1000);
+
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW);
+  g_assert (gst_clock_get_time (clock) >= t2 + 1000);
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+
+  /* a reader still in follow mode can't push the time past a pause */
+  reader = g_thread_new ("reader", read_loop, clock);
+  for (i = 0; i < SWITCHES; i++)
+  {
+    gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW);
+    gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+    t1 = gst_clock_get_time (clock);
+    gst_synchronous_clock_advance_time (clock, 1000);
+    g_assert (gst_clock_get_time (clock) == t1 + 1000);
+  }
+  g_atomic_int_set (&done, TRUE);
+  g_thread_join (reader);
+
+  g_object_unref (clock);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <gst/gst.h>
+#include <gst/audio/gstaudiobasesink.h>
+#include <gstsynchronousclock.h>
+
+#define SLEEP 200000 /* us */
+
+/* An audio sink without a ring buffer: its clock never moves by itself */
+typedef GstAudioBaseSink TestAudioSink;
+typedef GstAudioBaseSinkClass TestAudioSinkClass;
+
+G_DEFINE_TYPE (TestAudioSink, test_audio_sink, GST_TYPE_AUDIO_BASE_SINK)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static void
+test_audio_sink_class_init (TestAudioSinkClass *klass)
+{
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &sink_template);
+}
+
+static void
+test_audio_sink_init (TestAudioSink *self)
+{
+}
+
+static void
+test_audio_sinks (void)
+{
+  GstClock *clock;
+  GstElement *bin, *inner, *sink1, *sink2;
+  GstClock *follower;
+  GstAudioBaseSinkSlaveMethod method;
+  GstSynchronousClockRecord records[64];
+  GstClockTime t;
+  uint64_t cursor = 0;
+
+  /* the timeline shows each wake-up while following the wall clock */
+  clock = g_object_new (GST_TYPE_SYNCHRONOUSCLOCK, "timeline-size", 64, NULL);
+  bin = gst_bin_new (NULL);
+  inner = gst_bin_new (NULL);
+  sink1 = g_object_new (test_audio_sink_get_type (), NULL);
+  sink2 = g_object_new (test_audio_sink_get_type (), NULL);
+  gst_bin_add_many (GST_BIN (inner), sink2, 
+      gst_element_factory_make ("fakesink", NULL), NULL);
+  gst_bin_add_many (GST_BIN (bin), sink1, inner, NULL);
+
+  /* sinks in nested bins are found, other elements are skipped */
+  g_assert (gst_synchronous_clock_follow_audio_sinks (clock, 
+        GST_BIN (bin)) == 2);
+
+  g_object_get (G_OBJECT (sink2), "slave-method", &method, NULL);
+  g_assert (method == GST_AUDIO_BASE_SINK_SLAVE_NONE);
+
+  /* the sink's clock is exactly where the advance left the clock */
+  follower = GST_AUDIO_BASE_SINK (sink2)->provided_clock;
+  gst_synchronous_clock_advance_time (clock, 2 * GST_SECOND);
+  g_assert (gst_clock_get_time (follower) == 2 * GST_SECOND);
+
+  /* while following the wall clock, it is re-anchored every tick */
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_FOLLOW);
+  g_usleep (SLEEP);
+  t = gst_clock_get_time (clock);
+  g_assert (t >= 2 * GST_SECOND + SLEEP * GST_USECOND);
+  g_assert (t - gst_clock_get_time (follower) < SLEEP * GST_USECOND / 2);
+  g_assert (gst_synchronous_clock_read_timeline (clock, &cursor, records, 
+        64) > 0);
+
+  /* tearing the bin down releases its clocks and stops the wake-ups */
+  g_object_add_weak_pointer (G_OBJECT (follower), (gpointer *) &follower);
+  g_assert (gst_synchronous_clock_unfollow_audio_sinks (clock, 
+        GST_BIN (bin)) == 2);
+  gst_object_unref (bin);
+  g_assert (follower == NULL);
+
+  g_usleep (SLEEP / 10);
+  gst_synchronous_clock_read_timeline (clock, &cursor, records, 64);
+  g_usleep (SLEEP);
+  g_assert (gst_synchronous_clock_read_timeline (clock, &cursor, records, 
+        64) == 0);
+
+  gst_synchronous_clock_set_mode (clock, GST_SYNCHRONOUS_CLOCK_MODE_MANUAL);
+  g_object_unref (clock);
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock, *follower;
+  GstClockTime t;
+
+  gst_init (&argc, &argv);
+
+  clock = gst_synchronous_clock_new ();
+  follower = g_object_new (GST_TYPE_SYSTEM_CLOCK, NULL);
+  g_assert (clock);
+  g_assert (follower);
+
+  gst_synchronous_clock_add_follower (clock, follower);
+
+  /* the follower picks each advance up right away */
+  gst_synchronous_clock_advance_time (clock, 5 * GST_SECOND);
+  t = gst_clock_get_time (follower);
+  g_assert (t >= 5 * GST_SECOND && t < 6 * GST_SECOND);
+
+  gst_synchronous_clock_advance_time (clock, 5 * GST_SECOND);
+  t = gst_clock_get_time (follower);
+  g_assert (t >= 10 * GST_SECOND && t < 11 * GST_SECOND);
+
+  /* and is left alone once removed */
+  gst_synchronous_clock_remove_follower (clock, follower);
+  gst_synchronous_clock_advance_time (clock, 50 * GST_SECOND);
+  g_assert (gst_clock_get_time (follower) < 11 * GST_SECOND);
+
+  gst_object_unref (follower);
+  g_object_unref (clock);
+
+  test_audio_sinks ();
+  return 0;
+}
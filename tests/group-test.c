@@ -0,0 +1,107 @@
+#include <gst/gst.h>
+#include <gstsynchronousclock.h>
+#include <gstsynchronousclockgroup.h>
+
+#define N_PIPELINES 4
+
+static GstClock *sync_clock;
+static GstElement *pipelines[N_PIPELINES];
+static GstClockTime playing_at[N_PIPELINES];
+static gboolean done = FALSE;
+
+/* another controller, moving the time all along */
+static gpointer
+advance_loop (gpointer data)
+{
+  while (!g_atomic_int_get (&done))
+  {
+    gst_synchronous_clock_advance_time (sync_clock, GST_MSECOND);
+    g_usleep (100);
+  }
+  return NULL;
+}
+
+/* running time of a pipeline when it reaches PLAYING */
+static GstBusSyncReply
+state_changed_cb (GstBus *bus, GstMessage *message, gpointer user_data)
+{
+  gint i = GPOINTER_TO_INT (user_data);
+  GstState state;
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_STATE_CHANGED
+      && GST_MESSAGE_SRC (message) == GST_OBJECT (pipelines[i]))
+  {
+    gst_message_parse_state_changed (message, NULL, &state, NULL);
+    if (state == GST_STATE_PLAYING)
+      playing_at[i] = gst_clock_get_time (sync_clock)
+          - gst_element_get_base_time (pipelines[i]);
+  }
+
+  return GST_BUS_DROP;
+}
+
+int main(int argc, char *argv[])
+{
+  GstSynchronousClockGroup *group;
+  GstClockTime base_time;
+  GThread *controller;
+  GstBus *bus;
+  int i;
+
+  gst_init (&argc, &argv);
+
+  sync_clock = gst_synchronous_clock_new ();
+  g_assert (sync_clock);
+  gst_synchronous_clock_advance_time (sync_clock, GST_SECOND);
+
+  group = gst_synchronous_clock_group_new (sync_clock, -1);
+  g_assert (group);
+
+  for (i = 0; i < N_PIPELINES; i++)
+  {
+    pipelines[i] = gst_parse_launch (
+        "fakesrc num-buffers=1 ! fakesink sync=true", NULL);
+    g_assert (pipelines[i]);
+    playing_at[i] = GST_CLOCK_TIME_NONE;
+    bus = gst_element_get_bus (pipelines[i]);
+    gst_bus_set_sync_handler (bus, state_changed_cb, GINT_TO_POINTER (i),
+        NULL);
+    gst_object_unref (bus);
+    gst_synchronous_clock_group_add (group, GST_PIPELINE (pipelines[i]));
+  }
+
+  controller = g_thread_new ("controller", advance_loop, NULL);
+  g_usleep (1000);
+  g_assert (gst_synchronous_clock_group_start (group, GST_CLOCK_TIME_NONE));
+
+  /* all started together, the time held at their common base time until
+   * every one of them was PLAYING */
+  base_time = gst_element_get_base_time (pipelines[0]);
+  g_assert (base_time >= GST_SECOND);
+  for (i = 0; i < N_PIPELINES; i++)
+  {
+    GstState state;
+    gst_element_get_state (pipelines[i], &state, NULL, GST_CLOCK_TIME_NONE);
+    g_assert (state == GST_STATE_PLAYING);
+    g_assert (gst_element_get_base_time (pipelines[i]) == base_time);
+    g_assert (playing_at[i] == 0);
+
+    /* and their start time is back */
+    g_assert (gst_element_get_start_time (pipelines[i]) == 0);
+  }
+
+  /* the controller moves the time again */
+  g_usleep (1000);
+  g_assert (gst_clock_get_time (sync_clock) > base_time);
+  g_atomic_int_set (&done, TRUE);
+  g_thread_join (controller);
+
+  gst_synchronous_clock_group_free (group);
+  for (i = 0; i < N_PIPELINES; i++)
+  {
+    gst_element_set_state (pipelines[i], GST_STATE_NULL);
+    gst_object_unref (pipelines[i]);
+  }
+  g_object_unref (sync_clock);
+  return 0;
+}
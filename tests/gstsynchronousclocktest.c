@@ -102,7 +102,7 @@ int
 main(int argc, char *argv[])
 {
   GstBus *bus;
-  GstClock *clock, *audioclock;
+  GstClock *clock;
 
   if (argc < 2)
   {
@@ -129,8 +129,6 @@ main(int argc, char *argv[])
 
   g_object_set (G_OBJECT (decodebin), "uri", argv[1], NULL);
   g_object_set (G_OBJECT (playsink), "audio-sink", alsasink, NULL);
-  
-  GST_OBJECT_FLAG_SET (G_OBJECT(alsasink), GST_CLOCK_FLAG_CAN_SET_MASTER);
 
   gst_bin_add_many (GST_BIN (pipeline), decodebin, playsink, NULL);
   
@@ -142,11 +140,10 @@ main(int argc, char *argv[])
   gst_element_set_state (pipeline, GST_STATE_PLAYING);
   gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
 
-  /* Setting 'clock' as master of 'audioclock' */
-  audioclock = GST_AUDIO_BASE_SINK (alsasink)->provided_clock;
-  if (!gst_clock_set_master (audioclock, clock))
-    printf ("Could not slave audioclock (%p) to clock (%p)\n", 
-        (void *) audioclock, (void *) clock);
+  /* Making the audio sinks follow each advance of 'clock' */
+  if (gst_synchronous_clock_follow_audio_sinks (clock, GST_BIN (pipeline)) == 0)
+    printf ("Could not find an audio sink to follow clock (%p)\n", 
+        (void *) clock);
 
   t = g_get_monotonic_time ();
   g_timeout_add (freq, timer_cb, clock);
@@ -154,6 +151,7 @@ main(int argc, char *argv[])
 
   if (GST_STATE (pipeline) != GST_STATE_NULL)
     gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_synchronous_clock_unfollow_audio_sinks (clock, GST_BIN (pipeline));
 
   g_object_unref (clock);
   g_main_loop_unref (loop);
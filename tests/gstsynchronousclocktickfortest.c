@@ -105,7 +105,7 @@ int
 main(int argc, char *argv[])
 {
   GstBus *bus;
-  GstClock *clock, *audioclock;
+  GstClock *clock;
   gint64 dur;
   cancellable = g_cancellable_new ();
 
@@ -134,10 +134,6 @@ main(int argc, char *argv[])
 
   g_object_set (G_OBJECT (decodebin), "uri", argv[1], NULL);
   g_object_set (G_OBJECT (playsink), "audio-sink", alsasink, NULL);
-  g_object_set (G_OBJECT (alsasink), "slave-method", 
-      GST_AUDIO_BASE_SINK_SLAVE_SKEW, NULL);
-  
-  GST_OBJECT_FLAG_SET (G_OBJECT(alsasink), GST_CLOCK_FLAG_CAN_SET_MASTER);
 
   gst_bin_add_many (GST_BIN (pipeline), decodebin, playsink, NULL);
   
@@ -151,19 +147,17 @@ main(int argc, char *argv[])
 
   gst_element_query_duration (decodebin, GST_FORMAT_TIME, &dur);
 
-  /* Setting 'clock' as master of 'audioclock' */
-  audioclock = GST_AUDIO_BASE_SINK (alsasink)->provided_clock;
-  gst_clock_set_timeout (audioclock, freq * MS_TO_NS);
-
-  if (!gst_clock_set_master (audioclock, clock))
-    printf ("Could not slave audioclock (%p) to clock (%p)\n", 
-        (void *) audioclock, (void *) clock);
+  /* Making the audio sinks follow each advance of 'clock' */
+  if (gst_synchronous_clock_follow_audio_sinks (clock, GST_BIN (pipeline)) == 0)
+    printf ("Could not find an audio sink to follow clock (%p)\n", 
+        (void *) clock);
  
   g_thread_unref (g_thread_new ("main-loop", main_loop_thread, NULL));
   gst_synchronous_clock_tick_for (clock, (uint64_t)dur, cancellable);
 
   if (GST_STATE (pipeline) != GST_STATE_NULL)
     gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_synchronous_clock_unfollow_audio_sinks (clock, GST_BIN (pipeline));
 
   g_object_unref (clock);
   g_main_loop_unref (loop);
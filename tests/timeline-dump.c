@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gio/gio.h>
+#include <gstsynchronousclock.h>
+
+#define TIMELINE_SIZE 65536
+
+GCancellable *cancellable;
+
+static GstBusSyncReply
+bus_sync_cb (GstBus *bus, GstMessage *message, gpointer user_data)
+{
+  switch (GST_MESSAGE_TYPE (message))
+  {
+    case GST_MESSAGE_ERROR:
+    {
+      GError *err;
+      gchar *debug;
+
+      gst_message_parse_error (message, &err, &debug);
+      fprintf (stderr, "Error: %s\n", err->message);
+      g_error_free (err);
+      g_free (debug);
+
+      g_cancellable_cancel (cancellable);
+      break;
+    }
+    case GST_MESSAGE_EOS:
+      g_cancellable_cancel (cancellable);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BUS_PASS;
+}
+
+/* Runs a launch line on a synchronous clock for some seconds of clock time
+ * and dumps the clock's timeline to a file, for offline analysis */
+int
+main(int argc, char *argv[])
+{
+  GstElement *pipeline;
+  GstClock *clock;
+  GstBus *bus;
+  GFile *file;
+  GFileOutputStream *stream;
+  GstSynchronousClockDumpFormat format = GST_SYNCHRONOUS_CLOCK_DUMP_CSV;
+  GError *error = NULL;
+  gdouble seconds;
+  int ret = EXIT_SUCCESS;
+
+  if (argc < 4)
+  {
+    printf ("Usage: %s <launch line> <seconds> <output file> "
+        "[csv|binary]\n", argv[0]);
+    return EXIT_SUCCESS;
+  }
+  if (argc > 4 && strcmp (argv[4], "binary") == 0)
+    format = GST_SYNCHRONOUS_CLOCK_DUMP_BINARY;
+  seconds = g_ascii_strtod (argv[2], NULL);
+
+  gst_init (&argc, &argv);
+  cancellable = g_cancellable_new ();
+
+  pipeline = gst_parse_launch (argv[1], &error);
+  if (pipeline == NULL)
+  {
+    fprintf (stderr, "Could not create the pipeline: %s\n", error->message);
+    g_error_free (error);
+    return EXIT_FAILURE;
+  }
+
+  bus = gst_element_get_bus (pipeline);
+  gst_bus_set_sync_handler (bus, bus_sync_cb, NULL, NULL);
+  gst_object_unref (bus);
+
+  clock = g_object_new (GST_TYPE_SYNCHRONOUSCLOCK, "timeline-size",
+      TIMELINE_SIZE, NULL);
+  gst_pipeline_use_clock (GST_PIPELINE (pipeline), clock);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  gst_synchronous_clock_tick_for (clock,
+      (uint64_t) (seconds * GST_SECOND), cancellable);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  file = g_file_new_for_commandline_arg (argv[3]);
+  stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL,
+      &error);
+  if (stream == NULL
+      || !gst_synchronous_clock_dump_timeline (clock,
+        G_OUTPUT_STREAM (stream), format, &error)
+      || !g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &error))
+  {
+    fprintf (stderr, "Could not dump the timeline: %s\n", error->message);
+    g_error_free (error);
+    ret = EXIT_FAILURE;
+  }
+
+  if (stream != NULL)
+    g_object_unref (stream);
+  g_object_unref (file);
+  g_object_unref (clock);
+  gst_object_unref (pipeline);
+  g_object_unref (cancellable);
+
+  return ret;
+}
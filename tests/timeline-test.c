@@ -0,0 +1,118 @@
+#include <string.h>
+#include <gst/gst.h>
+#include <gio/gio.h>
+#include <gstsynchronousclock.h>
+
+#define CSV_HEADER "time,wall_time,released,source\n"
+#define ADVANCES 1000
+#define STEP 1000
+
+static gpointer
+advance_loop (gpointer data)
+{
+  int i;
+
+  for (i = 0; i < ADVANCES; i++)
+    gst_synchronous_clock_advance_time_from (data, STEP,
+        GST_SYNCHRONOUS_CLOCK_SOURCE_USER);
+  return NULL;
+}
+
+static gboolean
+release_cb (GstClock *clock, GstClockTime time, GstClockID id, 
+    gpointer user_data)
+{
+  return TRUE;
+}
+
+int main(int argc, char *argv[])
+{
+  GstClock *clock;
+  GstClockID clock_id;
+  GstSynchronousClockRecord records[8];
+  GstSynchronousClockRecord *all;
+  GOutputStream *stream;
+  GThread *threads[2];
+  gboolean *seen;
+  uint64_t cursor = 0;
+  guint n;
+  int i;
+
+  gst_init (&argc, &argv);
+
+  clock = g_object_new (GST_TYPE_SYNCHRONOUSCLOCK, "timeline-size", 4, NULL);
+  g_assert (clock);
+
+  clock_id = gst_clock_new_single_shot_id (clock, 5500);
+  gst_clock_id_wait_async (clock_id, release_cb, NULL, NULL);
+
+  for (i = 0; i < 5; i++)
+    gst_synchronous_clock_advance_time (clock, 1000);
+  gst_synchronous_clock_advance_time_from (clock, 1000, 
+      GST_SYNCHRONOUS_CLOCK_SOURCE_USER);
+
+  /* the oldest records were overwritten, the latest 4 are kept */
+  n = gst_synchronous_clock_read_timeline (clock, &cursor, records, 8);
+  g_assert (n == 4);
+  g_assert (records[0].time == 3000);
+  g_assert (records[1].time == 4000);
+  g_assert (records[2].time == 5000);
+  g_assert (records[2].released == 0);
+  g_assert (records[2].source == GST_SYNCHRONOUS_CLOCK_SOURCE_API);
+  g_assert (records[3].time == 6000);
+  g_assert (records[3].released == 1);
+  g_assert (records[3].source == GST_SYNCHRONOUS_CLOCK_SOURCE_USER);
+  g_assert (records[2].wall_time <= records[3].wall_time);
+
+  /* nothing new since the last read */
+  g_assert (gst_synchronous_clock_read_timeline (clock, &cursor, records, 8)
+      == 0);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert (gst_synchronous_clock_dump_timeline (clock, stream, 
+        GST_SYNCHRONOUS_CLOCK_DUMP_CSV, NULL));
+  g_assert (g_memory_output_stream_get_data_size (
+        G_MEMORY_OUTPUT_STREAM (stream)) > strlen (CSV_HEADER));
+  g_assert (strncmp (g_memory_output_stream_get_data (
+          G_MEMORY_OUTPUT_STREAM (stream)), CSV_HEADER, 
+        strlen (CSV_HEADER)) == 0);
+  g_object_unref (stream);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert (gst_synchronous_clock_dump_timeline (clock, stream, 
+        GST_SYNCHRONOUS_CLOCK_DUMP_BINARY, NULL));
+  g_assert (g_memory_output_stream_get_data_size (
+        G_MEMORY_OUTPUT_STREAM (stream)) 
+      == 4 * sizeof (GstSynchronousClockRecord));
+  g_object_unref (stream);
+
+  gst_clock_id_unref (clock_id);
+  g_object_unref (clock);
+
+  /* concurrent advances each get their own record, with the exact time
+   * they took the clock to */
+  clock = g_object_new (GST_TYPE_SYNCHRONOUSCLOCK, "timeline-size", 
+      2 * ADVANCES, NULL);
+  for (i = 0; i < 2; i++)
+    threads[i] = g_thread_new ("advance", advance_loop, clock);
+  for (i = 0; i < 2; i++)
+    g_thread_join (threads[i]);
+
+  all = g_new0 (GstSynchronousClockRecord, 2 * ADVANCES);
+  seen = g_new0 (gboolean, 2 * ADVANCES);
+  cursor = 0;
+  n = gst_synchronous_clock_read_timeline (clock, &cursor, all, 
+      2 * ADVANCES);
+  g_assert (n == 2 * ADVANCES);
+  for (i = 0; i < 2 * ADVANCES; i++)
+  {
+    g_assert (all[i].time % STEP == 0);
+    g_assert (all[i].time >= STEP && all[i].time <= 2 * ADVANCES * STEP);
+    g_assert (!seen[all[i].time / STEP - 1]);
+    seen[all[i].time / STEP - 1] = TRUE;
+  }
+  g_free (seen);
+  g_free (all);
+  g_object_unref (clock);
+  return 0;
+}